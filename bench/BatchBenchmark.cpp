@@ -0,0 +1,96 @@
+/*
+ * BatchBenchmark.cpp
+ *
+ * Mutual information and KL divergence of many small distributions,
+ * comparing one call per distribution with one call per batch. The
+ * approximate logarithm needs a vectorizing build (e.g. -O3 -mavx2)
+ * to pay off.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "prob"
+
+RVAR_STATIC(X, 4)
+RVAR_STATIC(Y, 3)
+
+typedef prob::distribution<double, X, prob::given, Y> DistXgY;
+typedef prob::distribution<double, Y> DistY;
+
+template<typename F>
+double time_it(F f, int repetitions)
+{
+  auto start = std::chrono::high_resolution_clock::now();
+
+  for(int r = 0; r < repetitions; ++r)
+    f();
+
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count() / repetitions;
+}
+
+int main(int argc, char **argv)
+{
+  std::mt19937 gen(0);
+  const int sizes[] = { 100, 1000, 10000, 100000 };
+
+  std::cout << "members\tI single [ms]\tI batch [ms]\tI batch approx [ms]"
+      << "\tKL single [ms]\tKL batch [ms]" << std::endl;
+
+  for(int n : sizes)
+  {
+    std::vector<DistXgY> pXgY(n);
+    std::vector<DistY> pY(n), qY(n);
+    prob::distribution_batch<double, X, prob::given, Y> bXgY(n, DistXgY());
+    prob::distribution_batch<double, Y> bY(n, DistY()), cY(n, DistY());
+
+    for(int k = 0; k < n; ++k)
+    {
+      prob::init::random(pXgY[k], gen);
+      prob::init::random(pY[k], gen);
+      prob::init::random(qY[k], gen);
+      bXgY.set(k, pXgY[k]);
+      bY.set(k, pY[k]);
+      cY.set(k, qY[k]);
+    }
+
+    int repetitions = std::max(1, 1000000 / n);
+    double checksum = 0;
+
+    double i_single = time_it([&] ()
+        {
+          for(int k = 0; k < n; ++k)
+            checksum += prob::it::mutual_information(pXgY[k], pY[k]);
+        }, repetitions);
+
+    double i_batch = time_it([&] ()
+        {
+          checksum += prob::it::batch::mutual_information(bXgY, bY).sum();
+        }, repetitions);
+
+    double i_approx = time_it([&] ()
+        {
+          checksum += prob::it::batch::mutual_information<prob::it::approximate_log>(
+              bXgY, bY).sum();
+        }, repetitions);
+
+    double kl_single = time_it([&] ()
+        {
+          for(int k = 0; k < n; ++k)
+            checksum += prob::it::kl_divergence(pY[k], qY[k]);
+        }, repetitions);
+
+    double kl_batch = time_it([&] ()
+        {
+          checksum += prob::it::batch::kl_divergence(bY, cY).sum();
+        }, repetitions);
+
+    std::cout << n << "\t" << i_single << "\t" << i_batch << "\t" << i_approx
+        << "\t" << kl_single
+        << "\t" << kl_batch << "\t(checksum " << checksum << ")" << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,76 @@
+/*
+ * ContractionBenchmark.cpp
+ *
+ * Cost of one step of the chain rule of a Markov chain,
+ * p(x|z) = sum_y p(x|y)p(y|z), for n states per variable, comparing an
+ * index based loop with the matrix products of contract.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include "prob"
+
+RVAR(X)
+RVAR(Y)
+RVAR(Z)
+
+typedef prob::distribution<double, X, prob::given, Y> DistXgY;
+typedef prob::distribution<double, Y, prob::given, Z> DistYgZ;
+typedef prob::distribution<double, X, prob::given, Z> DistXgZ;
+
+template<typename F>
+double time_contraction(F f, int repetitions)
+{
+  auto start = std::chrono::high_resolution_clock::now();
+
+  for(int r = 0; r < repetitions; ++r)
+    f();
+
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count() / repetitions;
+}
+
+int main(int argc, char **argv)
+{
+  std::mt19937 gen(0);
+  const int extents[] = { 4, 16, 64, 256, 512 };
+
+  std::cout << "states\tindex loop [ms]\tcontract [ms]" << std::endl;
+
+  for(int n : extents)
+  {
+    DistXgY pXgY(X(n)|Y(n));
+    DistYgZ pYgZ(Y(n)|Z(n));
+    prob::init::random(pXgY, gen);
+    prob::init::random(pYgZ, gen);
+
+    int repetitions = std::max(1, 100000000 / (n * n * n));
+
+    double checksum = 0;
+
+    double loop = time_contraction([&] ()
+        {
+          DistXgZ pXgZ(X(n)|Z(n));
+          pXgZ.each_index([&] (const X& x, prob::given g, const Z& z)
+              {
+                double p = 0;
+                for(int y = 0; y < n; ++y)
+                  p += pXgY(x|Y(y)) * pYgZ(Y(y)|z);
+                pXgZ.prob_ref(x, g, z) = p;
+              });
+          checksum += pXgZ.coeff(0);
+        }, std::max(1, repetitions / 10));
+
+    double contracted = time_contraction([&] ()
+        {
+          DistXgZ pXgZ = prob::contract<X, Z>(pXgY, pYgZ);
+          checksum += pXgZ.coeff(0);
+        }, repetitions);
+
+    std::cout << n << "\t" << loop << "\t" << contracted
+        << "\t(checksum " << checksum << ")" << std::endl;
+  }
+
+  return 0;
+}
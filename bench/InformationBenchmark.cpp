@@ -0,0 +1,96 @@
+/*
+ * InformationBenchmark.cpp
+ *
+ * Cost of the entropy and the mutual information of tables from 16 to
+ * 10^6 cells, comparing the formerly used temporaries (map_copy, joint
+ * and marginal) with the fused kernels in precise and approximate mode.
+ * The approximate mode only pays off when the fast logarithm is
+ * vectorized, e.g. with -O3 -mavx2.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include "prob"
+
+RVAR(X)
+RVAR(Y)
+
+typedef prob::distribution<double, X, Y> DistXY;
+typedef prob::distribution<double, X, prob::given, Y> DistXgY;
+typedef prob::distribution<double, Y> DistY;
+
+template<typename F>
+double time_it(F f, int repetitions)
+{
+  auto start = std::chrono::high_resolution_clock::now();
+
+  for(int r = 0; r < repetitions; ++r)
+    f();
+
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count() / repetitions;
+}
+
+int main(int argc, char **argv)
+{
+  std::mt19937 gen(0);
+  const int extents[][2] = { {4, 4}, {32, 32}, {100, 100}, {316, 316},
+      {1000, 1000} };
+
+  std::cout << "cells\tH copy [ms]\tH precise [ms]\tH approx [ms]"
+      << "\tI joint [ms]\tI precise [ms]\tI approx [ms]" << std::endl;
+
+  for(auto& e : extents)
+  {
+    DistXgY pXgY = DistXgY(X(e[0])|Y(e[1]));
+    DistY pY = DistY(Y(e[1]));
+    prob::init::random(pXgY, gen);
+    prob::init::random(pY, gen);
+    DistXY pXY(prob::uncondition(pXgY, pY));
+
+    int cells = e[0] * e[1];
+    int repetitions = std::max(1, 10000000 / cells);
+
+    double checksum = 0;
+
+    double h_copy = time_it([&] ()
+        {
+          checksum -= pXY.map_copy([] (double v)
+              { return prob::it::xlogy(v, v); }).sum() / prob::it::log_of_2<double>();
+        }, repetitions);
+
+    double h_precise = time_it([&] ()
+        {
+          checksum += prob::it::entropy(pXY);
+        }, repetitions);
+
+    double h_approx = time_it([&] ()
+        {
+          checksum += prob::it::entropy<prob::it::approximate_log>(pXY);
+        }, repetitions);
+
+    double i_joint = time_it([&] ()
+        {
+          DistXY dXY(prob::uncondition(pXgY, pY));
+          prob::distribution<double, X> dX(dXY.marginalize<0>());
+          checksum += prob::it::mutual_information(pXgY, dX, pY);
+        }, repetitions);
+
+    double i_precise = time_it([&] ()
+        {
+          checksum += prob::it::mutual_information(pXgY, pY);
+        }, repetitions);
+
+    double i_approx = time_it([&] ()
+        {
+          checksum += prob::it::mutual_information<prob::it::approximate_log>(pXgY, pY);
+        }, repetitions);
+
+    std::cout << cells << "\t" << h_copy << "\t" << h_precise << "\t" << h_approx
+        << "\t" << i_joint << "\t" << i_precise << "\t" << i_approx
+        << "\t(checksum " << checksum << ")" << std::endl;
+  }
+
+  return 0;
+}
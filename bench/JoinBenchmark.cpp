@@ -0,0 +1,76 @@
+/*
+ * JoinBenchmark.cpp
+ *
+ * Cost of joining two independent distributions into tables from 16
+ * to 10^7 cells, comparing the index based loop with the outer product
+ * kernel of join.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include "prob"
+
+RVAR(X)
+RVAR(Y)
+
+typedef prob::distribution<double, X> DistX;
+typedef prob::distribution<double, Y> DistY;
+typedef prob::core::join_impl<DistX, DistY> join_type;
+
+template<typename F>
+double time_join(F f, int repetitions)
+{
+  auto start = std::chrono::high_resolution_clock::now();
+
+  for(int r = 0; r < repetitions; ++r)
+    f();
+
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count() / repetitions;
+}
+
+int main(int argc, char **argv)
+{
+  std::mt19937 gen(0);
+  const int extents[][2] = { {4, 4}, {32, 32}, {100, 100}, {316, 316},
+      {1000, 1000}, {3163, 3163} };
+
+  std::cout << "cells\tgeneric [ms]\touter product [ms]" << std::endl;
+
+  for(auto& e : extents)
+  {
+    DistX pX = DistX(X(e[0]));
+    DistY pY = DistY(Y(e[1]));
+    prob::init::random(pX, gen);
+    prob::init::random(pY, gen);
+
+    int cells = e[0] * e[1];
+    int repetitions = std::max(1, 10000000 / cells);
+
+    double checksum = 0;
+
+    double generic = time_join([&] ()
+        {
+          join_type::return_type pXY;
+          pXY.reshape_dimensions(std::make_tuple(),
+              prob::util::tuple::concat(pX.col_extents(), pY.col_extents()));
+          pXY.each_index([&] (const X& x, const Y& y)
+              {
+                pXY.prob_ref(x, y) = pX(x) * pY(y);
+              });
+          checksum += pXY.coeff(0);
+        }, repetitions);
+
+    double outer = time_join([&] ()
+        {
+          join_type::return_type pXY(prob::join(pX, pY));
+          checksum += pXY.coeff(0);
+        }, repetitions);
+
+    std::cout << cells << "\t" << generic << "\t" << outer
+        << "\t(checksum " << checksum << ")" << std::endl;
+  }
+
+  return 0;
+}
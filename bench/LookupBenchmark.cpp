@@ -0,0 +1,75 @@
+/*
+ * LookupBenchmark.cpp
+ *
+ * Per lookup cost of element access, comparing the folded tuple
+ * index computation with the stride based offsets of distribution.
+ */
+
+#include <chrono>
+#include <iostream>
+#include "prob"
+
+RVAR(X)
+RVAR(Y)
+RVAR(Z)
+RVAR(W)
+
+typedef prob::distribution<double, X, Y, prob::given, Z, W> DistXYgZW;
+
+/* The index path before strides were stored in the distribution */
+double folded_lookup(const DistXYgZW& d, const X& x, const Y& y,
+    const Z& z, const W& w)
+{
+  int row = std::get<0>(prob::util::tuple::fold(
+      prob::core::element_index_accu,
+      std::make_tuple(0,1),
+      prob::util::tuple::zip(std::make_tuple(z, w), d.row_extents())));
+
+  int col = std::get<0>(prob::util::tuple::fold(
+      prob::core::element_index_accu,
+      std::make_tuple(0,1),
+      prob::util::tuple::zip(std::make_tuple(x, y), d.col_extents())));
+
+  return d.coeff(row, col);
+}
+
+template<typename F>
+double time_lookups(const char* name, const DistXYgZW& d, int repetitions, F f)
+{
+  double sum = 0;
+  auto start = std::chrono::high_resolution_clock::now();
+
+  for(int r = 0; r < repetitions; ++r)
+    for(X x = 0; x < 16; ++x)
+      for(Y y = 0; y < 16; ++y)
+        for(Z z = 0; z < 16; ++z)
+          for(W w = 0; w < 16; ++w)
+            sum += f(x, y, z, w);
+
+  auto end = std::chrono::high_resolution_clock::now();
+  double ns = std::chrono::duration<double, std::nano>(end - start).count();
+
+  std::cout << name << ": " << ns / (repetitions * d.size())
+      << " ns per lookup (checksum " << sum << ")" << std::endl;
+
+  return sum;
+}
+
+int main(int argc, char **argv)
+{
+  int repetitions = argc > 1 ? atoi(argv[1]) : 100;
+
+  DistXYgZW d(X(16), Y(16) | Z(16), W(16));
+  d.setOnes();
+  d.normalize();
+
+  time_lookups("folded tuples ", d, repetitions,
+      [&d] (const X& x, const Y& y, const Z& z, const W& w)
+      { return folded_lookup(d, x, y, z, w); });
+
+  time_lookups("strides       ", d, repetitions,
+      [&d] (const X& x, const Y& y, const Z& z, const W& w)
+      { return d(x, y | z, w); });
+
+  return 0;
+}
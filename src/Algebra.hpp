@@ -37,6 +37,33 @@ namespace prob
 
     template<typename ...T>
     struct bayes_impl;
+    /** @endcond */
+
+    /**
+     * @brief Elementwise reciprocal that maps 0 to 0
+     */
+    template<typename Scalar>
+    struct safe_inverse
+    {
+      Scalar operator()(Scalar v) const
+      {
+        return v == 0 ? Scalar(0) : Scalar(1) / v;
+      }
+    };
+
+    /**
+     * @brief Elementwise reciprocal of a matrix, zero entries stay zero
+     *
+     * Used to turn the divisions of conditioning into a single broadcast
+     * multiplication.
+     */
+    template<typename Derived>
+    typename Derived::PlainObject safe_reciprocal(const Eigen::MatrixBase<Derived>& m)
+    {
+      return m.unaryExpr(safe_inverse<typename Derived::Scalar>());
+    }
+
+    /** @cond PRIVATE */
 
     template<template<typename ...> class V,
     typename DistA,
@@ -49,20 +76,23 @@ namespace prob
     {
       typedef distribution<Scalar, A..., B..., given, C...> return_type;
 
-      static return_type join_conditionals(const DistA& distA, const DistB& distB)
+      template<typename Executor>
+      static return_type join_conditionals(const DistA& distA, const DistB& distB,
+          const Executor& ex)
       {
-        //int rows = distA.rows();
-        //int cols = distA.cols() * distB.cols();
         auto col_extents = util::tuple::concat(distA.col_extents(),distB.col_extents());
         return_type result;
         result.reshape_dimensions(distA.row_extents(), col_extents);
 
-        result.each_index(
-          [&] (const A&...  a, const B&... b, given g, const C&... c)
-          {
-            result.prob_ref(a..., b..., g, c...) =
-              distA(a...,g,c...) * distB(b...,g,c...);
-          });
+        // Column a*|B|+b of the result is the column a of A times
+        // the column b of B, broadcast over all b at once
+        int colsB = distB.cols();
+        ex.parallel_for(0, distA.cols(), [&] (int begin, int end)
+            {
+              for(int a = begin; a < end; ++a)
+                result.middleCols(a * colsB, colsB).array() =
+                    distB.array().colwise() * distA.col(a).array();
+            });
 
         return result;
       }
@@ -76,18 +106,23 @@ namespace prob
     {
       typedef V<Scalar, A..., B...> return_type;
 
-      static return_type join(const V<Scalar, A...>& distA, const V<Scalar, B...>& distB)
+      template<typename Executor>
+      static return_type join(const V<Scalar, A...>& distA, const V<Scalar, B...>& distB,
+          const Executor& ex)
       {
         auto col_extents = util::tuple::concat(distA.col_extents(),distB.col_extents());
         return_type result;
 
         result.reshape_dimensions(std::make_tuple<>(), col_extents);
 
-        result.each_index(
-            [&] (const A&... a, const B&... b)
+        // The flattened result is the outer product of B and A with
+        // the variables of B being the inner most, i.e. each block
+        // of |B| cells is B scaled by one probability of A
+        int colsB = distB.cols();
+        ex.parallel_for(0, distA.cols(), [&] (int begin, int end)
             {
-              result.prob_ref(a...,b...) =
-              distA(a...) * distB(b...);
+              for(int a = begin; a < end; ++a)
+                result.middleCols(a * colsB, colsB).noalias() = distA.coeff(a) * distB;
             });
 
         return result;
@@ -101,7 +136,9 @@ namespace prob
     {
       typedef distribution<Scalar, A..., B...> return_type;
 
-      static return_type uncondition(const DistAgB& distAgB, const DistB& distB)
+      template<typename Executor>
+      static return_type uncondition(const DistAgB& distAgB, const DistB& distB,
+          const Executor& ex)
       {
         //int cols = distAgB.rows()*distAgB.cols();
 
@@ -115,7 +152,7 @@ namespace prob
               given g(0);
               result.prob_ref(a..., b...) =
               distAgB(a...,g,b...) * distB(b...);
-            });
+            }, ex);
 
         return result;
       }
@@ -128,20 +165,26 @@ namespace prob
     {
       typedef distribution<Scalar, A..., B..., given, C...> return_type;
 
-      static return_type partial_uncondition(const DistAgBC& distAgBC, const DistBgC& distBgC)
+      template<typename Executor>
+      static return_type partial_uncondition(const DistAgBC& distAgBC, const DistBgC& distBgC,
+          const Executor& ex)
       {
-        //int rows = distBgC.rows();
-        //int cols = distAgBC.cols()*distBgC.cols();
-
         auto col_extents = util::tuple::concat(distAgBC.col_extents(), distBgC.col_extents());
         return_type result;
         result.reshape_dimensions(distBgC.row_extents(), col_extents);
 
-        result.each_index(
-            [&] (const A&... a, const B&... b,
-                given g, const C&... c)
+        typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> block_type;
+        int rowsC = distBgC.rows();
+        int colsB = distBgC.cols();
+
+        // The column a of A|B,C viewed as a |C| x |B| matrix is multiplied
+        // elementwise with B|C giving the columns a*|B|, ..., a*|B|+|B|-1
+        ex.parallel_for(0, distAgBC.cols(), [&] (int begin, int end)
             {
-              result.prob_ref(a..., b..., g, c...) = distAgBC(a..., g, b..., c...) * distBgC(b..., g, c...);
+              for(int a = begin; a < end; ++a)
+                result.middleCols(a * colsB, colsB) =
+                    Eigen::Map<const block_type>(distAgBC.col(a).data(), rowsC, colsB)
+                    .cwiseProduct(distBgC);
             });
 
         return result;
@@ -155,28 +198,30 @@ namespace prob
     {
       typedef distribution<Scalar, A..., given, B...> return_type;
 
+      template<typename Executor>
       static void condition(const DistAB& distAB, const DistB& distB,
-          return_type& distAgB)
+          return_type& distAgB, const Executor& ex)
       {
-
-        //unsigned rows = distB.cols();
-        //unsigned cols = distAB.cols() / rows;
         auto col_extents = util::tuple::subset(
             distAB.col_extents(),
             typename util::compile_time_list::iota_0<sizeof...(A)>::type());
 
         distAgB.reshape_dimensions(distB.col_extents(), col_extents);
 
-        distAgB.each_index(
-            [&] (const A&... a, given g, const B&... b)
+        typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> block_type;
+
+        // The flattened joint viewed as a |B| x |A| matrix has the same
+        // layout as the result, rows are scaled by 1/p(b)
+        typename DistB::matrix_type inverse = safe_reciprocal(distB);
+        Eigen::Map<const block_type> joint(distAB.data(), distB.cols(), distAgB.cols());
+        Eigen::Map<block_type> conditional(distAgB.data(), distAgB.rows(), distAgB.cols());
+
+        ex.parallel_for(0, distAgB.cols(), [&] (int begin, int end)
             {
-              Scalar v = distB(b...);
-              if(v==0)
-              distAgB.prob_ref(a..., g, b...) = 0;
-              else
-              distAgB.prob_ref(a..., g, b...) = distAB(a...,b...) / v;
+              conditional.middleCols(begin, end - begin) =
+                  joint.middleCols(begin, end - begin).array().colwise() *
+                  inverse.transpose().array();
             });
-
       }
     };
 
@@ -187,13 +232,11 @@ namespace prob
     {
       typedef distribution<Scalar, A..., given, B..., C...> return_type;
 
+      template<typename Executor>
       static void condition_conditionals(const DistABgC& distABgC,
           const DistBgC& distBgC,
-          return_type& distAgBC)
+          return_type& distAgBC, const Executor& ex)
       {
-
-        //unsigned cols = distABgC.cols() / distBgC.cols();
-        //unsigned rows = distBgC.cols() * distBgC.rows();
         auto col_extents = util::tuple::subset(
             distABgC.col_extents(),
             typename util::compile_time_list::iota_0<sizeof...(A)>::type());
@@ -203,15 +246,18 @@ namespace prob
 
         distAgBC.reshape_dimensions(row_extents, col_extents);
 
-        distAgBC.each_index(
-            [&] (const A&... a, given g,
-                const B&... b, const C&... c)
+        typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> block_type;
+        typename DistBgC::matrix_type inverse = safe_reciprocal(distBgC);
+        int rowsC = distBgC.rows();
+        int colsB = distBgC.cols();
+
+        // The column a of the result viewed as a |C| x |B| matrix is
+        // the block of columns a*|B|, ..., a*|B|+|B|-1 divided by p(b|c)
+        ex.parallel_for(0, distAgBC.cols(), [&] (int begin, int end)
             {
-              Scalar v = distBgC(b..., g, c...);
-              if(v==0)
-              distAgBC.prob_ref(a..., g, b..., c...) = 0;
-              else
-              distAgBC.prob_ref(a..., g, b..., c...) = distABgC(a...,b..., g, c...) / v;
+              for(int a = begin; a < end; ++a)
+                Eigen::Map<block_type>(distAgBC.col(a).data(), rowsC, colsB) =
+                    distABgC.middleCols(a * colsB, colsB).cwiseProduct(inverse);
             });
       }
     };
@@ -225,29 +271,33 @@ namespace prob
     typedef distribution<Scalar, A...> marginalA_type;
     typedef distribution<Scalar, B...> marginalB_type;
 
+    template<typename Executor>
     static return_type bayes(const conditional_type& distAgB,
         const marginalA_type& distA,
-        const marginalB_type& distB)
+        const marginalB_type& distB,
+        const Executor& ex)
     {
-      //int rows = distAgB.cols();
-      //int cols = distAgB.rows();
-
       return_type result;
       result.reshape_dimensions(distAgB.col_extents(), distAgB.row_extents());
 
-        result.each_index(
-          [&] (const B&...  b, given g, const A&... a)
+      // p(b|a) is the transpose of p(a|b) with columns scaled by p(b)
+      // and rows scaled by 1/p(a)
+      typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> block_type;
+      typename marginalA_type::matrix_type inverse = safe_reciprocal(distA);
+      Eigen::Map<block_type> posterior(result.data(), result.rows(), result.cols());
+
+      ex.parallel_for(0, result.cols(), [&] (int begin, int end)
           {
-            Scalar v = distA(a...);
-            if(v==0)
-              result.prob_ref(b..., g, a...) = 0;
-            else
-              result.prob_ref(b..., g, a...) = distAgB(a...,g,b...) * distB(b...) / v;
+            int n = end - begin;
+            posterior.middleCols(begin, n) =
+                (distAgB.middleRows(begin, n).transpose().array().rowwise() *
+                distB.middleCols(begin, n).array())
+                .colwise() * inverse.transpose().array();
           });
 
-        return result;
-      }
-    };
+      return result;
+    }
+  };
     /** @endcond */
   }
 
@@ -262,13 +312,14 @@ namespace prob
    *
    * @param dA @f$ p(a...) @f$ of type \ref distribution<Scalar, A...>
    * @param dB @f$ p(b...) @f$ of type \ref distribution<Scalar, B...>
+   * @param ex Executor the cells of a... are distributed over
    * @return @f$ p(a..., b...) @f$ of type \ref distribution<Scalar, A..., B...>
    */
-  template<typename DistA, typename DistB>
-    auto join(const DistA& dA, const DistB& dB) ->
-    decltype(core::join_impl<DistA, DistB>::join(dA,dB))
+  template<typename DistA, typename DistB, typename Executor = serial_executor>
+    auto join(const DistA& dA, const DistB& dB, const Executor& ex = Executor()) ->
+    decltype(core::join_impl<DistA, DistB>::join(dA,dB,ex))
     {
-      return core::join_impl<DistA, DistB>::join(dA,dB);
+      return core::join_impl<DistA, DistB>::join(dA,dB,ex);
     }
 
   /**
@@ -276,19 +327,21 @@ namespace prob
    *
    * @param dA @f$ p(a...|c...) @f$ of type \ref distribution<Scalar, A..., \ref given, C...>
    * @param dB @f$ p(b...|c...) @f$ of type \ref distribution<Scalar, B..., \ref given, C...>
+   * @param ex Executor the cells of a... are distributed over
    * @return @f$ p(a..., b...|c...) @f$ of type \ref distribution<Scalar, A..., B..., \ref given, C...>
    * @todo Proper naming scheme
    */
-  template<typename DistA, typename DistB>
-  auto join_conditionals(const DistA& dA, const DistB& dB) ->
+  template<typename DistA, typename DistB, typename Executor = serial_executor>
+  auto join_conditionals(const DistA& dA, const DistB& dB,
+      const Executor& ex = Executor()) ->
   decltype(core::join_conditionals_impl<typename DistA::conditional_type,
       typename DistA::posterior_type,
       typename DistB::posterior_type,
-      typename DistA::scalar,DistA, DistB>::join_conditionals(dA,dB))
+      typename DistA::scalar,DistA, DistB>::join_conditionals(dA,dB,ex))
   {
     return core::join_conditionals_impl<typename DistA::conditional_type,
         typename DistA::posterior_type, typename DistB::posterior_type,
-        typename DistA::scalar, DistA, DistB>::join_conditionals(dA, dB);
+        typename DistA::scalar, DistA, DistB>::join_conditionals(dA, dB, ex);
   }
 
   /**
@@ -296,19 +349,21 @@ namespace prob
    *
    * @param dAgB @f$ p(a...|b...) @f$ of type \ref distribution<Scalar, A..., \ref given, B...>
    * @param dB @f$ p(b...) @f$ of type \ref distribution<Scalar, B...>
+   * @param ex Executor the cells of a... are distributed over
    * @return @f$ p(a..., b...) @f$ of type \ref distribution<Scalar, A..., B...>
    */
-  template<typename DistAgB, typename DistB>
-  auto uncondition(const DistAgB& dAgB, const DistB& dB) ->
+  template<typename DistAgB, typename DistB, typename Executor = serial_executor>
+  auto uncondition(const DistAgB& dAgB, const DistB& dB,
+      const Executor& ex = Executor()) ->
   decltype(core::uncondition_impl<
       typename DistAgB::conditional_type,
       typename DistAgB::posterior_type,
       typename DistAgB::scalar,
-      DistAgB, DistB>::uncondition(dAgB,dB))
+      DistAgB, DistB>::uncondition(dAgB,dB,ex))
   {
     return core::uncondition_impl<typename DistAgB::conditional_type,
         typename DistAgB::posterior_type, typename DistAgB::scalar, DistAgB,
-        DistB>::uncondition(dAgB, dB);
+        DistB>::uncondition(dAgB, dB, ex);
   }
 
   /**
@@ -316,21 +371,23 @@ namespace prob
    *
    * @param dAgBC @f$ p(a...|b...,c...) @f$ of type \ref distribution<Scalar, A..., \ref given, B..., C...>
    * @param dBgC @f$ p(b...|c...) @f$ of type \ref distribution<Scalar, B..., \ref given, C...>
+   * @param ex Executor the cells of a... are distributed over
    * @return @f$ p(a..., b...|c...) @f$ of type \ref distribution<Scalar, A..., B..., \ref given, C...>
    */
-  template<typename DistAgBC, typename DistBgC>
-  auto partial_uncondition(const DistAgBC& dAgBC, DistBgC& dBgC) ->
+  template<typename DistAgBC, typename DistBgC, typename Executor = serial_executor>
+  auto partial_uncondition(const DistAgBC& dAgBC, DistBgC& dBgC,
+      const Executor& ex = Executor()) ->
   decltype(core::partial_uncondition_impl<
       typename DistAgBC::posterior_type,
       typename DistBgC::conditional_type,
       typename DistBgC::posterior_type,
       typename DistAgBC::scalar,
-      DistAgBC, DistBgC>::partial_uncondition(dAgBC,dBgC))
+      DistAgBC, DistBgC>::partial_uncondition(dAgBC,dBgC,ex))
   {
     return core::partial_uncondition_impl<typename DistAgBC::posterior_type,
         typename DistBgC::conditional_type, typename DistBgC::posterior_type,
         typename DistAgBC::scalar, DistAgBC, DistBgC>::partial_uncondition(
-        dAgBC, dBgC);
+        dAgBC, dBgC, ex);
   }
 
   /**
@@ -340,14 +397,17 @@ namespace prob
    *
    * @param dAB @f$ p(a...,b...) @f$ of type \ref distribution<Scalar, A..., B...>
    * @param dB @f$ p(b...) @f$ of type \ref distribution<Scalar, B...>
+   * @param ex Executor the cells of a... are distributed over
    * @return @f$ p(a...| b...) @f$ of type \ref distribution<Scalar, A..., \ref given, B...>
    */
-  template<typename DistAB, typename DistB, typename DistAgB>
-  void condition(const DistAB& dAB, const DistB& dB, DistAgB& dAgB)
+  template<typename DistAB, typename DistB, typename DistAgB,
+  typename Executor = serial_executor>
+  void condition(const DistAB& dAB, const DistB& dB, DistAgB& dAgB,
+      const Executor& ex = Executor())
   {
     core::condition_impl<typename DistAgB::posterior_type,
         typename DistAgB::conditional_type, typename DistAB::scalar, DistAB,
-        DistB>::condition(dAB, dB, dAgB);
+        DistB>::condition(dAB, dB, dAgB, ex);
   }
 
   /**
@@ -358,15 +418,17 @@ namespace prob
    * @param dABgC @f$ p(a...,b...|c...) @f$ of type \ref distribution<Scalar, A..., B..., \ref given, C...>
    * @param dBgC @f$ p(b...) @f$ of type \ref distribution<Scalar, B..., \ref given, C...>
    * @param dAgBC Reference to @f$ p(a...| b..., c...) @f$ of type \ref distribution<Scalar, A..., \ref given, B..., C...>
+   * @param ex Executor the cells of a... are distributed over
    */
-  template<typename DistABgC, typename DistBgC, typename DistAgBC>
+  template<typename DistABgC, typename DistBgC, typename DistAgBC,
+  typename Executor = serial_executor>
   void condition_conditionals(const DistABgC& dABgC, const DistBgC& dBgC,
-      DistAgBC& dAgBC)
+      DistAgBC& dAgBC, const Executor& ex = Executor())
   {
     core::condition_conditionals_impl<typename DistAgBC::posterior_type,
         typename DistBgC::posterior_type, typename DistBgC::conditional_type,
         typename DistABgC::scalar, DistABgC, DistBgC>::condition_conditionals(
-        dABgC, dBgC, dAgBC);
+        dABgC, dBgC, dAgBC, ex);
   }
 
   /**
@@ -377,18 +439,21 @@ namespace prob
    * @param dAgB @f$ p(a...,b...) @f$ of type \ref distribution<Scalar, A..., \ref given, B...>
    * @param dA @f$ p(a...) @f$ of type \ref distribution<Scalar, A...>
    * @param dB @f$ p(b...) @f$ of type \ref distribution<Scalar, B...>
+   * @param ex Executor the cells of b... are distributed over
    * @return @f$ p(b...| a...) @f$ of type \ref distribution<Scalar, B..., \ref given, A...>
    */
-  template<typename DistAgB, typename DistA, typename DistB>
-  auto bayes(const DistAgB& dAgB, const DistA& dA, const DistB& dB) ->
+  template<typename DistAgB, typename DistA, typename DistB,
+  typename Executor = serial_executor>
+  auto bayes(const DistAgB& dAgB, const DistA& dA, const DistB& dB,
+      const Executor& ex = Executor()) ->
   decltype(core::bayes_impl<
       typename DistAgB::posterior_type,
       typename DistAgB::conditional_type,
-      typename DistAgB::scalar>::bayes(dAgB, dA, dB))
+      typename DistAgB::scalar>::bayes(dAgB, dA, dB, ex))
   {
     return core::bayes_impl<typename DistAgB::posterior_type,
         typename DistAgB::conditional_type, typename DistAgB::scalar>::bayes(
-        dAgB, dA, dB);
+        dAgB, dA, dB, ex);
   }
 
   /**
@@ -411,13 +476,251 @@ namespace prob
    *
    * @param d The probability distribution
    * @param index An instance of the index list
+   * @param ex Executor the reduction is distributed over
    * @return The marginalized distribution
    */
-  template<typename Dist, template<size_t...> class I, size_t... Indices>
-  auto marginalize(const Dist& d, I<Indices...> index) ->
-  decltype(d.template marginalize<Indices...>())
+  template<typename Dist, template<size_t...> class I, size_t... Indices,
+  typename Executor = serial_executor>
+  auto marginalize(const Dist& d, I<Indices...> index,
+      const Executor& ex = Executor()) ->
+  decltype(d.template marginalize<Indices...>(ex))
+  {
+    return d.template marginalize<Indices...>(ex);
+  }
+
+  namespace core
+  {
+    /** @brief Multiplies each value by a constant weight */
+    template<typename Scalar>
+    struct scale_functor
+    {
+      Scalar w;
+
+      Scalar operator()(Scalar v) const
+      {
+        return v * w;
+      }
+    };
+
+    /**
+     * @brief Marginalization of a product @f$ p(a...|b...)p(b...) @f$ (or
+     * @f$ p(a...)p(b...) @f$) without forming the product
+     *
+     * Joint is the distribution over A..., B... the product would have.
+     * Each row b of the first factor is scaled by p(b) and summed straight
+     * into the marginal (see \ref strided_map_sum), only the marginal
+     * itself is allocated. Chunks of b... run on the executor, each into
+     * its own marginal which are added afterwards.
+     */
+    template<typename Joint, int... GroupIndices>
+    struct fused_marginalize_impl
+    {
+      typedef typename grouped_map_sum_impl<Joint, GroupIndices...>::result_type result_type;
+
+      /**
+       * @param dA The first factor, its posteriors are A...
+       * @param row_stride Offset between the rows b of dA in its buffer,
+       * 0 if the first factor does not depend on b...
+       * @param dB The second factor, its posteriors are B...
+       */
+      template<typename DistA, typename DistB, typename Executor>
+      static result_type apply(const DistA& dA, int row_stride, const DistB& dB,
+          const Executor& ex)
+      {
+        typedef typename DistA::scalar Scalar;
+        typedef typename accumulator<Scalar>::type Acc;
+        typedef Eigen::Array<Acc, Eigen::Dynamic, 1> acc_type;
+        typedef typename Joint::col_type joint_col_type;
+
+        static constexpr size_t PA = DistA::posterior_type::dim;
+        static constexpr size_t PB = DistB::posterior_type::dim;
+
+        joint_col_type joint_extents = util::tuple::concat(dA.col_extents(), dB.col_extents());
+
+        result_type result;
+        result.reshape_dimensions(std::make_tuple<>(),
+            util::tuple::subset(joint_extents, typename index_splitter<
+                joint_col_type, PA + PB, 0, GroupIndices...>::col_index_type()));
+
+        // Axes of a..., summed axes have no destination stride, and the
+        // destination strides of b...
+        std::array<strided_axis, PA> axes;
+        std::array<int, PA> a_extents = extent_array(dA.col_extents());
+        for(size_t i = 0; i < PA; ++i)
+          axes[i] = strided_axis { a_extents[i],
+              dA.col_strides()[i] * (int)dA.colStride(), 0 };
+
+        std::array<int, PB> b_extents = extent_array(dB.col_extents());
+        std::array<int, PB> b_dst;
+        b_dst.fill(0);
+
+        const int group_indices[] = { GroupIndices... };
+        for(size_t k = 0; k < sizeof...(GroupIndices); ++k)
+        {
+          size_t g = group_indices[k];
+          int stride = result.col_strides()[k] * (int)result.colStride();
+          if(g < PA)
+            axes[g].dst_stride = stride;
+          else
+            b_dst[g - PA] = stride;
+        }
+
+        auto contract = [&] (int begin, int end, Acc* dst)
+            {
+              for(int b = begin; b < end; ++b)
+              {
+                Scalar w = dB.coeff(b);
+                if(w == Scalar(0))
+                  continue;
+
+                int offset = 0;
+                for(size_t j = 0; j < PB; ++j)
+                  offset += (b / dB.col_strides()[j]) % b_extents[j] * b_dst[j];
+
+                strided_map_sum(dA.data() + b * row_stride, dst + offset, axes,
+                    scale_functor<Scalar> { w });
+              }
+            };
+
+        acc_type total = acc_type::Zero(result.size());
+
+        if(ex.concurrency() < 2)
+        {
+          contract(0, dB.cols(), total.data());
+        }
+        else
+        {
+          std::mutex lock;
+          ex.parallel_for(0, dB.cols(), [&] (int begin, int end)
+              {
+                acc_type local = acc_type::Zero(result.size());
+                contract(begin, end, local.data());
+
+                std::lock_guard<std::mutex> guard(lock);
+                total += local;
+              });
+        }
+
+        Eigen::Map<Eigen::Array<Scalar, Eigen::Dynamic, 1>>(result.data(), result.size()) =
+            total.template cast<Scalar>();
+        return result;
+      }
+    };
+
+    /**
+     * @brief Lazy @f$ p(a...|b...)p(b...) @f$, see \ref lazy::uncondition
+     */
+    template<typename DistAgB, typename DistB>
+    class uncondition_expression
+    {
+      const DistAgB& _dAgB;
+      const DistB& _dB;
+
+    public:
+      typedef typename uncondition_impl<typename DistAgB::conditional_type,
+          typename DistAgB::posterior_type, typename DistAgB::scalar,
+          DistAgB, DistB>::return_type distribution_type;
+
+      uncondition_expression(const DistAgB& dAgB, const DistB& dB) :
+          _dAgB(dAgB), _dB(dB)
+      {
+      }
+
+      /** @brief The product, see \ref prob::uncondition */
+      template<typename Executor = serial_executor>
+      distribution_type eval(const Executor& ex = Executor()) const
+      {
+        return prob::uncondition(_dAgB, _dB, ex);
+      }
+
+      operator distribution_type() const
+      {
+        return eval();
+      }
+
+      /** @brief The marginal of the product without forming the product */
+      template<int... GroupIndices, typename Executor = serial_executor>
+      typename fused_marginalize_impl<distribution_type, GroupIndices...>::result_type
+      marginalize(const Executor& ex = Executor()) const
+      {
+        return fused_marginalize_impl<distribution_type, GroupIndices...>::apply(
+            _dAgB, (int)_dAgB.rowStride(), _dB, ex);
+      }
+    };
+
+    /**
+     * @brief Lazy @f$ p(a...)p(b...) @f$, see \ref lazy::join
+     */
+    template<typename DistA, typename DistB>
+    class join_expression
+    {
+      const DistA& _dA;
+      const DistB& _dB;
+
+    public:
+      typedef typename join_impl<DistA, DistB>::return_type distribution_type;
+
+      join_expression(const DistA& dA, const DistB& dB) :
+          _dA(dA), _dB(dB)
+      {
+      }
+
+      /** @brief The product, see \ref prob::join */
+      template<typename Executor = serial_executor>
+      distribution_type eval(const Executor& ex = Executor()) const
+      {
+        return prob::join(_dA, _dB, ex);
+      }
+
+      operator distribution_type() const
+      {
+        return eval();
+      }
+
+      /** @brief The marginal of the product without forming the product */
+      template<int... GroupIndices, typename Executor = serial_executor>
+      typename fused_marginalize_impl<distribution_type, GroupIndices...>::result_type
+      marginalize(const Executor& ex = Executor()) const
+      {
+        return fused_marginalize_impl<distribution_type, GroupIndices...>::apply(
+            _dA, 0, _dB, ex);
+      }
+    };
+  }
+
+  /**
+   * @brief Lazily evaluated products
+   *
+   * The functions return expressions that keep references to their
+   * arguments. An expression is evaluated when it is assigned to a
+   * distribution (or by eval()), a marginalization of an expression is
+   * fused into a single pass over the factors that never allocates the
+   * product:
+   *
+   * @code
+   * // p(x) = sum_{y,z} p(x,y|z) p(z), only p(x) is allocated
+   * distribution<double, X> pX = lazy::uncondition(pXYgZ, pZ).marginalize<0>();
+   * distribution<double, X> qX = marginalize(lazy::uncondition(pXYgZ, pZ), index_type());
+   * @endcode
+   *
+   * The arguments need to outlive the expression.
+   */
+  namespace lazy
   {
-    return d.template marginalize<Indices...>();
+    /** @brief Lazy \ref prob::uncondition */
+    template<typename DistAgB, typename DistB>
+    core::uncondition_expression<DistAgB, DistB> uncondition(const DistAgB& dAgB,
+        const DistB& dB)
+    {
+      return core::uncondition_expression<DistAgB, DistB>(dAgB, dB);
+    }
+
+    /** @brief Lazy \ref prob::join */
+    template<typename DistA, typename DistB>
+    core::join_expression<DistA, DistB> join(const DistA& dA, const DistB& dB)
+    {
+      return core::join_expression<DistA, DistB>(dA, dB);
+    }
   }
 
 	/**
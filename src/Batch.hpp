@@ -0,0 +1,147 @@
+#ifndef _BATCH_H_
+#define _BATCH_H_
+
+/**
+ * @file Batch.hpp
+ *
+ * @brief Many distributions of identical shape in one buffer
+ */
+
+namespace prob
+{
+  /**
+   * @brief A batch of distributions over the same random variables with
+   * the same extents
+   *
+   * The batch is stored structure of arrays: for every cell of the
+   * distribution the values of all members of the batch are contiguous.
+   * Operations that work cell by cell (see \ref it::batch) thereby run
+   * vectorized across the members instead of once per member.
+   *
+   * The cells are numbered as the storage of the distribution type, i.e.
+   * the cell of the matrix coordinates (row, col) is \ref cell(row, col).
+   *
+   * @code
+   * distribution<double, X, given, Y> pXgY(X(4)|Y(3));
+   * distribution_batch<double, X, given, Y> batch(10000, pXgY);
+   *
+   * for(int k = 0; k < batch.size(); ++k)
+   *   batch.set(k, agent_policy(k));
+   *
+   * Eigen::ArrayXd h = it::batch::conditional_entropy(batch, batchY);
+   * @endcode
+   */
+  template<typename Scalar, typename ...T>
+  class distribution_batch
+  {
+  public:
+    typedef distribution<Scalar, T...> distribution_type;
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> matrix_type;
+    typedef Eigen::Array<Scalar, Eigen::Dynamic, 1> result_type;
+    typedef Scalar scalar;
+
+    /** @brief An empty batch */
+    distribution_batch()
+    {
+    }
+
+    /**
+     * @brief A batch of n zero initialized distributions shaped like the
+     * given distribution
+     *
+     * Only the extents of shape are used, not its values.
+     */
+    distribution_batch(int n, const distribution_type& shape) :
+        _shape(Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic>::Zero(
+            shape.rows(), shape.cols()),
+            shape.row_extents(), shape.col_extents())
+    {
+      _values.setZero(n, shape.size());
+    }
+
+    /** @brief Number of distributions in the batch */
+    int size() const
+    {
+      return _values.rows();
+    }
+
+    /** @brief Number of cells of each distribution */
+    int cells() const
+    {
+      return _values.cols();
+    }
+
+    /** @brief Number of rows of the matrix of each distribution */
+    int rows() const
+    {
+      return _shape.rows();
+    }
+
+    /** @brief Number of columns of the matrix of each distribution */
+    int cols() const
+    {
+      return _shape.cols();
+    }
+
+    /** @brief Storage position of the given matrix coordinates */
+    int cell(int row, int col) const
+    {
+      return row * _shape.rowStride() + col * _shape.colStride();
+    }
+
+    /** @brief Copy a distribution into the batch at position k */
+    void set(int k, const distribution_type& d)
+    {
+      assert(d.size() == cells());
+      _values.row(k) = Eigen::Map<const Eigen::Matrix<Scalar, 1, Eigen::Dynamic>>(
+          d.data(), cells());
+    }
+
+    /** @brief Copy of the distribution at position k */
+    distribution_type get(int k) const
+    {
+      distribution_type d(_shape);
+      Eigen::Map<Eigen::Matrix<Scalar, 1, Eigen::Dynamic>>(d.data(), cells()) =
+          _values.row(k);
+      return d;
+    }
+
+    /** @brief The values of one cell across all members of the batch */
+    typename matrix_type::ColXpr values(int cell)
+    {
+      return _values.col(cell);
+    }
+
+    /** @brief The values of one cell across all members of the batch */
+    typename matrix_type::ConstColXpr values(int cell) const
+    {
+      return _values.col(cell);
+    }
+
+    /**
+     * @brief The backing matrix, one row per member and one column per cell
+     */
+    matrix_type& matrix()
+    {
+      return _values;
+    }
+
+    /** @brief The backing matrix */
+    const matrix_type& matrix() const
+    {
+      return _values;
+    }
+
+    /** @brief A distribution with the shape of the members */
+    const distribution_type& shape() const
+    {
+      return _shape;
+    }
+
+  private:
+    distribution_type _shape;
+    matrix_type _values;
+  };
+}
+
+#endif /* _BATCH_H_ */
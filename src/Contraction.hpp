@@ -0,0 +1,604 @@
+#ifndef _CONTRACTION_H_
+#define _CONTRACTION_H_
+
+#include <vector>
+
+/**
+ * @file Contraction.hpp
+ *
+ * @brief Sums of products of two distributions over named variables
+ *
+ * A contraction multiplies two tables cellwise along the variables they
+ * share and sums out all variables that are not kept, e.g.
+ * @f$ p(x|z) = \sum_y p(x|y)p(y|z) @f$. The variables are classified by
+ * their role, grouped into the dimensions of a batch of matrix products and
+ * the products are handed to Eigen's blocked (cache tiled) matrix product.
+ */
+
+namespace prob
+{
+  namespace core
+  {
+    /**
+     * @brief Roles of the variables of a contraction
+     */
+    enum contraction_role
+    {
+      /** In both factors and in the result, indexes a batch of products */
+      contraction_batch,
+      /** In the first factor and in the result only */
+      contraction_left,
+      /** In the second factor and in the result only */
+      contraction_right,
+      /** In both factors but not in the result, summed by the products */
+      contraction_inner,
+      /** In one of the factors only and not in the result, summed first */
+      contraction_summed
+    };
+
+    /**
+     * @brief A variable of an operand of a contraction
+     *
+     * The position orders the variables of one role, it is the same in
+     * all operands the variable appears in.
+     */
+    struct contraction_variable
+    {
+      contraction_role role;
+      int position;
+      int extent;
+      int stride;
+    };
+
+    /**
+     * @brief Variables flattened into one dimension of a matrix
+     *
+     * Variables are appended from the outer most to the inner most one,
+     * the group is fused if they are contiguous in this order, i.e. the
+     * whole group is addressed by the stride of its inner most variable.
+     */
+    struct contraction_group
+    {
+      int extent;
+      int stride;
+      bool fused;
+
+      contraction_group() :
+          extent(1), stride(1), fused(true)
+      {
+      }
+
+      void append(int e, int s)
+      {
+        if(e == 1)
+          return;
+
+        if(extent > 1)
+          fused = fused && stride == s * e;
+
+        extent *= e;
+        stride = s;
+      }
+    };
+
+    /**
+     * @brief The variables of one role ordered by their position
+     *
+     * @return The number of variables written to order
+     */
+    template<size_t N>
+    size_t contraction_order(const std::array<contraction_variable, N>& vars,
+        contraction_role role, std::array<size_t, N>& order)
+    {
+      size_t n = 0;
+      for(size_t i = 0; i < N; ++i)
+        if(vars[i].role == role)
+          order[n++] = i;
+
+      for(size_t i = 1; i < n; ++i)
+        for(size_t j = i; j > 0 && vars[order[j - 1]].position > vars[order[j]].position; --j)
+          std::swap(order[j - 1], order[j]);
+
+      return n;
+    }
+
+    /** @brief The variables of one role as a matrix dimension */
+    template<size_t N>
+    contraction_group contraction_dimension(
+        const std::array<contraction_variable, N>& vars, contraction_role role)
+    {
+      std::array<size_t, N> order;
+      size_t n = contraction_order(vars, role, order);
+
+      contraction_group group;
+      for(size_t i = 0; i < n; ++i)
+        group.append(vars[order[i]].extent, vars[order[i]].stride);
+
+      return group;
+    }
+
+    /**
+     * @brief Whether an operand can be used in place as a column major
+     * matrix with the variables of role rows as its rows
+     */
+    template<size_t N>
+    bool contraction_mappable(const std::array<contraction_variable, N>& vars,
+        contraction_role rows, contraction_role cols)
+    {
+      for(size_t i = 0; i < N; ++i)
+        if(vars[i].role == contraction_summed)
+          return false;
+
+      contraction_group r = contraction_dimension(vars, rows);
+      contraction_group c = contraction_dimension(vars, cols);
+
+      return r.fused && c.fused && (r.extent == 1 || r.stride == 1);
+    }
+
+    /**
+     * @brief The layout of an operand packed into one column major matrix
+     * per batch, stacked in the order of the batch variables
+     */
+    template<size_t N>
+    std::array<contraction_variable, N> contraction_packed(
+        std::array<contraction_variable, N> vars, contraction_role rows,
+        contraction_role cols)
+    {
+      std::array<size_t, N> order;
+      const contraction_role roles[] = { rows, cols, contraction_batch };
+
+      int stride = 1;
+      for(contraction_role role : roles)
+      {
+        size_t n = contraction_order(vars, role, order);
+        for(size_t i = n; i-- > 0;)
+        {
+          vars[order[i]].stride = stride;
+          stride *= vars[order[i]].extent;
+        }
+      }
+
+      for(size_t i = 0; i < N; ++i)
+        if(vars[i].role == contraction_summed)
+          vars[i].stride = 0;
+
+      return vars;
+    }
+
+    /** @brief The offset of each matrix of the batch */
+    template<size_t N>
+    std::vector<int> contraction_offsets(const std::array<contraction_variable, N>& vars)
+    {
+      std::array<size_t, N> order;
+      size_t n = contraction_order(vars, contraction_batch, order);
+
+      std::vector<int> offsets(1, 0);
+      for(size_t i = 0; i < n; ++i)
+      {
+        const contraction_variable& v = vars[order[i]];
+        std::vector<int> next(offsets.size() * v.extent);
+        for(size_t o = 0; o < offsets.size(); ++o)
+          for(int e = 0; e < v.extent; ++e)
+            next[o * v.extent + e] = offsets[o] + e * v.stride;
+        offsets.swap(next);
+      }
+
+      return offsets;
+    }
+
+    /** @brief Axes copying a table from the layout src to the layout dst */
+    template<size_t N>
+    std::array<strided_axis, N> contraction_axes(
+        const std::array<contraction_variable, N>& src,
+        const std::array<contraction_variable, N>& dst)
+    {
+      std::array<strided_axis, N> axes;
+      for(size_t i = 0; i < N; ++i)
+        axes[i] = strided_axis { src[i].extent, src[i].stride, dst[i].stride };
+      return axes;
+    }
+
+    /**
+     * @brief A batch of column major matrices, either a distribution in
+     * place or a packed copy of it
+     */
+    template<typename Scalar>
+    struct contraction_operand
+    {
+      const Scalar* source;
+      std::vector<Scalar> buffer;
+      std::vector<int> offsets;
+      int rows;
+      int cols;
+      int outer_stride;
+
+      template<size_t N, typename Executor>
+      contraction_operand(const Scalar* d,
+          const std::array<contraction_variable, N>& vars, contraction_role r,
+          contraction_role c, const Executor& ex)
+      {
+        std::array<contraction_variable, N> layout = vars;
+
+        if(!contraction_mappable(vars, r, c))
+        {
+          layout = contraction_packed(vars, r, c);
+
+          int size = 1;
+          for(size_t i = 0; i < N; ++i)
+            if(vars[i].role != contraction_summed)
+              size *= vars[i].extent;
+
+          buffer.assign(size, Scalar(0));
+          accumulated_map_sum(d, buffer.data(), size,
+              contraction_axes(vars, layout), identity_functor(), ex);
+        }
+
+        contraction_group gr = contraction_dimension(layout, r);
+        contraction_group gc = contraction_dimension(layout, c);
+
+        source = d;
+        offsets = contraction_offsets(layout);
+        rows = gr.extent;
+        cols = gc.extent;
+        outer_stride = gc.extent == 1 ? rows : gc.stride;
+      }
+
+      /** @brief The first matrix, packed or in place */
+      const Scalar* data() const
+      {
+        return buffer.empty() ? source : buffer.data();
+      }
+    };
+
+    /**
+     * @brief Contraction of the tables a and b into the table c
+     *
+     * Every variable is described by its role, extent and stride in each
+     * of the operands. Of the two equivalent formulations as matrix
+     * products per batch, @f$ C = AB @f$ and @f$ C^T = B^TA^T @f$, the one
+     * that can use more operands in place is chosen, the others are
+     * packed (which also sums out the variables of only one factor).
+     * Batches, or columns of the result if there is a single batch, are
+     * distributed over the executor.
+     */
+    template<typename Scalar, size_t NA, size_t NB, size_t NC, typename Executor>
+    void contraction(const Scalar* a, const std::array<contraction_variable, NA>& va,
+        const Scalar* b, const std::array<contraction_variable, NB>& vb,
+        Scalar* c, const std::array<contraction_variable, NC>& vc,
+        const Executor& ex)
+    {
+      typedef typename accumulator<Scalar>::type Acc;
+      typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> matrix_type;
+      typedef Eigen::Map<const matrix_type, 0, Eigen::OuterStride<>> const_map_type;
+      typedef Eigen::Map<matrix_type, 0, Eigen::OuterStride<>> map_type;
+
+      int cost = !contraction_mappable(va, contraction_left, contraction_inner) +
+          !contraction_mappable(vb, contraction_inner, contraction_right) +
+          !contraction_mappable(vc, contraction_left, contraction_right);
+      int transposed_cost = !contraction_mappable(vb, contraction_right, contraction_inner) +
+          !contraction_mappable(va, contraction_inner, contraction_left) +
+          !contraction_mappable(vc, contraction_right, contraction_left);
+
+      bool transposed = transposed_cost < cost;
+      contraction_role rows = transposed ? contraction_right : contraction_left;
+      contraction_role cols = transposed ? contraction_left : contraction_right;
+
+      contraction_operand<Scalar> lhs = transposed ?
+          contraction_operand<Scalar>(b, vb, rows, contraction_inner, ex) :
+          contraction_operand<Scalar>(a, va, rows, contraction_inner, ex);
+      contraction_operand<Scalar> rhs = transposed ?
+          contraction_operand<Scalar>(a, va, contraction_inner, cols, ex) :
+          contraction_operand<Scalar>(b, vb, contraction_inner, cols, ex);
+
+      // The result is either written in place or packed and scattered
+      bool scatter = !contraction_mappable(vc, rows, cols);
+      std::array<contraction_variable, NC> layout = scatter ?
+          contraction_packed(vc, rows, cols) : vc;
+
+      std::vector<Scalar> buffer;
+      Scalar* dst = c;
+      if(scatter)
+      {
+        buffer.resize(lhs.rows * rhs.cols * lhs.offsets.size());
+        dst = buffer.data();
+      }
+
+      std::vector<int> offsets = contraction_offsets(layout);
+      contraction_group gc = contraction_dimension(layout, cols);
+      int outer_stride = gc.extent == 1 ? lhs.rows : gc.stride;
+
+      auto product = [&] (int batch, int begin, int end)
+          {
+            const_map_type l(lhs.data() + lhs.offsets[batch], lhs.rows, lhs.cols,
+                Eigen::OuterStride<>(lhs.outer_stride));
+            const_map_type r(rhs.data() + rhs.offsets[batch] + begin * rhs.outer_stride,
+                rhs.rows, end - begin, Eigen::OuterStride<>(rhs.outer_stride));
+            map_type o(dst + offsets[batch] + begin * outer_stride, lhs.rows, end - begin,
+                Eigen::OuterStride<>(outer_stride));
+
+            o.noalias() = (l.template cast<Acc>() * r.template cast<Acc>()).template cast<Scalar>();
+          };
+
+      int batches = offsets.size();
+      if(batches > 1)
+      {
+        ex.parallel_for(0, batches, [&] (int begin, int end)
+            {
+              for(int batch = begin; batch < end; ++batch)
+                product(batch, 0, rhs.cols);
+            });
+      }
+      else
+      {
+        ex.parallel_for(0, rhs.cols, [&] (int begin, int end)
+            {
+              product(0, begin, end);
+            });
+      }
+
+      if(scatter)
+      {
+        int size = buffer.size();
+        Eigen::Map<Eigen::Array<Scalar, Eigen::Dynamic, 1>>(c, size).setConstant(Scalar(0));
+        strided_map_sum(buffer.data(), c, contraction_axes(layout, vc), identity_functor());
+      }
+    }
+
+    /**
+     * @brief Extents and strides of the variables of a distribution,
+     * posteriors first
+     */
+    template<typename Dist, size_t N>
+    void contraction_layout(const Dist& d, std::array<contraction_variable, N>& vars)
+    {
+      static constexpr size_t P = Dist::posterior_type::dim;
+      static constexpr size_t C = Dist::conditional_type::dim;
+      static_assert(P + C == N, "Number of variables");
+
+      std::array<int, P> col_extents = extent_array(d.col_extents());
+      std::array<int, C> row_extents = extent_array(d.row_extents());
+
+      for(size_t i = 0; i < P; ++i)
+      {
+        vars[i].extent = col_extents[i];
+        vars[i].stride = d.col_strides()[i] * (int)d.colStride();
+      }
+
+      for(size_t i = 0; i < C; ++i)
+      {
+        vars[P + i].extent = row_extents[i];
+        vars[P + i].stride = d.row_strides()[i] * (int)d.rowStride();
+      }
+    }
+
+    /** @cond PRIVATE */
+    template<typename Factors, typename Posteriors, typename R>
+    struct contraction_split;
+
+    template<typename ...V, typename ...P>
+    struct contraction_split<vars<V...>, vars<P...>, vars<>>
+    {
+      typedef vars<> posterior_type;
+      typedef vars<> conditional_type;
+    };
+
+    template<typename ...V, typename ...P, typename H, typename ...R>
+    struct contraction_split<vars<V...>, vars<P...>, vars<H, R...>>
+    {
+      static_assert(util::traits::type_index<H, V...>::value >= 0,
+          "Variables of the contraction need to be variables of the factors");
+
+      typedef contraction_split<vars<V...>, vars<P...>, vars<R...>> tail;
+      static const bool posterior = util::traits::type_index<H, P...>::value >= 0;
+
+      typedef typename std::conditional<posterior,
+          typename util::traits::join<vars, vars<H>, typename tail::posterior_type>::type,
+          typename tail::posterior_type>::type posterior_type;
+
+      typedef typename std::conditional<posterior,
+          typename tail::conditional_type,
+          typename util::traits::join<vars, vars<H>, typename tail::conditional_type>::type>::type
+          conditional_type;
+    };
+
+    template<typename Scalar, typename P, typename C>
+    struct contraction_result;
+
+    template<typename Scalar, typename ...P, typename ...C>
+    struct contraction_result<Scalar, vars<P...>, vars<C...>>
+    {
+      typedef distribution<Scalar, P..., given, C...> type;
+    };
+
+    template<typename Scalar, typename ...P>
+    struct contraction_result<Scalar, vars<P...>, vars<>>
+    {
+      typedef distribution<Scalar, P...> type;
+    };
+
+    template<typename R, typename PA, typename CA, typename PB, typename CB,
+    typename RP, typename RC>
+    struct contraction_types;
+
+    template<typename ...R, typename ...PA, typename ...CA, typename ...PB,
+    typename ...CB, typename ...RP, typename ...RC>
+    struct contraction_types<vars<R...>, vars<PA...>, vars<CA...>, vars<PB...>,
+    vars<CB...>, vars<RP...>, vars<RC...>>
+    {
+      static_assert(util::traits::are_distinct<R...>::value,
+          "Variables of the contraction need to be distinct");
+      static_assert(util::traits::are_distinct<PA..., CA...>::value &&
+          util::traits::are_distinct<PB..., CB...>::value,
+          "Variables of the factors of a contraction need to be distinct");
+      static_assert(sizeof...(RP) > 0,
+          "The result of a contraction needs a posterior variable");
+
+      static constexpr size_t NA = sizeof...(PA) + sizeof...(CA);
+      static constexpr size_t NB = sizeof...(PB) + sizeof...(CB);
+      static constexpr size_t NC = sizeof...(RP) + sizeof...(RC);
+
+      /** @brief Sizes the result after the variables of the factors */
+      template<typename DistC, typename DistA, typename DistB>
+      static void reshape(DistC& dC, const DistA& dA, const DistB& dB)
+      {
+        auto extents = util::tuple::concat(
+            util::tuple::concat(dA.col_extents(), dA.row_extents()),
+            util::tuple::concat(dB.col_extents(), dB.row_extents()));
+
+        dC.reshape_dimensions(
+            std::make_tuple(std::get<util::traits::type_index<RC,
+                PA..., CA..., PB..., CB...>::value>(extents)...),
+            std::make_tuple(std::get<util::traits::type_index<RP,
+                PA..., CA..., PB..., CB...>::value>(extents)...));
+      }
+
+      /** @brief Assigns the roles of the variables of all operands */
+      static void roles(std::array<contraction_variable, NA>& va,
+          std::array<contraction_variable, NB>& vb,
+          std::array<contraction_variable, NC>& vc)
+      {
+        const int a_in_b[] = { util::traits::type_index<PA, PB..., CB...>::value...,
+            util::traits::type_index<CA, PB..., CB...>::value... };
+        const int a_in_c[] = { util::traits::type_index<PA, R...>::value...,
+            util::traits::type_index<CA, R...>::value... };
+        const int b_in_a[] = { util::traits::type_index<PB, PA..., CA...>::value...,
+            util::traits::type_index<CB, PA..., CA...>::value... };
+        const int b_in_c[] = { util::traits::type_index<PB, R...>::value...,
+            util::traits::type_index<CB, R...>::value... };
+        const int c_in_a[] = { util::traits::type_index<RP, PA..., CA...>::value...,
+            util::traits::type_index<RC, PA..., CA...>::value... };
+        const int c_in_b[] = { util::traits::type_index<RP, PB..., CB...>::value...,
+            util::traits::type_index<RC, PB..., CB...>::value... };
+
+        for(size_t i = 0; i < NA; ++i)
+        {
+          va[i].position = i;
+          if(a_in_c[i] >= 0)
+            va[i].role = a_in_b[i] >= 0 ? contraction_batch : contraction_left;
+          else
+            va[i].role = a_in_b[i] >= 0 ? contraction_inner : contraction_summed;
+        }
+
+        for(size_t i = 0; i < NB; ++i)
+        {
+          if(b_in_a[i] >= 0)
+          {
+            assert(vb[i].extent == va[b_in_a[i]].extent);
+            vb[i].role = va[b_in_a[i]].role;
+            vb[i].position = b_in_a[i];
+          }
+          else
+          {
+            vb[i].role = b_in_c[i] >= 0 ? contraction_right : contraction_summed;
+            vb[i].position = i;
+          }
+        }
+
+        for(size_t i = 0; i < NC; ++i)
+        {
+          if(c_in_a[i] >= 0)
+          {
+            vc[i].role = va[c_in_a[i]].role;
+            vc[i].position = c_in_a[i];
+          }
+          else
+          {
+            vc[i].role = contraction_right;
+            vc[i].position = c_in_b[i];
+          }
+        }
+      }
+    };
+
+    template<typename R, typename DistA, typename DistB>
+    struct contraction_impl
+    {
+      typedef typename DistA::scalar Scalar;
+      static_assert(std::is_same<Scalar, typename DistB::scalar>::value,
+          "Factors of a contraction need to have the same scalar type");
+
+      typedef typename util::traits::join<vars, typename DistA::posterior_type,
+          typename DistA::conditional_type>::type factor_type_a;
+      typedef typename util::traits::join<vars, typename DistB::posterior_type,
+          typename DistB::conditional_type>::type factor_type_b;
+      typedef typename util::traits::join<vars, factor_type_a, factor_type_b>::type factor_types;
+      typedef typename util::traits::join<vars, typename DistA::posterior_type,
+          typename DistB::posterior_type>::type factor_posteriors;
+
+      typedef contraction_split<factor_types, factor_posteriors, R> split;
+      typedef contraction_types<R, typename DistA::posterior_type,
+          typename DistA::conditional_type, typename DistB::posterior_type,
+          typename DistB::conditional_type, typename split::posterior_type,
+          typename split::conditional_type> types;
+
+      typedef typename contraction_result<Scalar, typename split::posterior_type,
+          typename split::conditional_type>::type return_type;
+
+      template<typename Executor>
+      static return_type contract(const DistA& dA, const DistB& dB, const Executor& ex)
+      {
+        return_type result;
+        types::reshape(result, dA, dB);
+
+        std::array<contraction_variable, types::NA> va;
+        std::array<contraction_variable, types::NB> vb;
+        std::array<contraction_variable, types::NC> vc;
+        contraction_layout(dA, va);
+        contraction_layout(dB, vb);
+        contraction_layout(result, vc);
+        types::roles(va, vb, vc);
+
+        contraction(dA.data(), va, dB.data(), vb, result.data(), vc, ex);
+        return result;
+      }
+    };
+    /** @endcond */
+  }
+
+  /**
+   * @addtogroup DIST
+   *
+   * @{
+   */
+
+  /**
+   * Returns the sum over all variables not in R... of the product of two
+   * distributions, the variables are matched by their type. E.g. the
+   * chain rule of a Markov chain
+   * @f[ p(x|z) = \sum_y p(x|y)p(y|z) @f]
+   * is
+   * @code
+   * distribution<double, X, given, Z> pXgZ = contract<X, Z>(pXgY, pYgZ);
+   * @endcode
+   * A variable of R... is a conditional of the result if it is a
+   * conditional in every factor it appears in, otherwise it is a
+   * posterior. The variables keep the order of R... within the posteriors
+   * and within the conditionals. Hence, contract<A..., B...>(pAgB, pB) is
+   * uncondition, contract<A..., B..., C...>(pAgC, pBgC) is
+   * join_conditionals and contract<A..., B..., C...>(pAgBC, pBgC) is
+   * partial_uncondition, and marginalizations of these products are
+   * computed without forming the products.
+   *
+   * The contraction runs as a batch of matrix products, see
+   * \ref core::contraction, and accumulates in
+   * \ref core::accumulator<Scalar>.
+   *
+   * @tparam R... The variables of the result
+   * @param dA The first factor
+   * @param dB The second factor, shared variables need the same extents
+   * @param ex Executor the batches of products or the columns of the
+   * result are distributed over
+   * @return @f$ \sum p(a...)p(b...) @f$ over the variables not in R...
+   */
+  template<typename ...R, typename DistA, typename DistB,
+  typename Executor = serial_executor>
+  typename core::contraction_impl<core::vars<R...>, DistA, DistB>::return_type
+  contract(const DistA& dA, const DistB& dB, const Executor& ex = Executor())
+  {
+    return core::contraction_impl<core::vars<R...>, DistA, DistB>::contract(dA, dB, ex);
+  }
+
+  /** @} */
+}
+
+#endif /* _CONTRACTION_H_ */
@@ -0,0 +1,239 @@
+#ifndef _COUNTS_H_
+#define _COUNTS_H_
+
+#include <mutex>
+
+/**
+ * @file Counts.hpp
+ *
+ * @brief Empirical distributions counted from streams of samples
+ */
+
+namespace prob
+{
+  /**
+   * @brief Streaming accumulator of sample counts over the random variables T...
+   *
+   * The counts are kept in the buffer of a distribution<double, T...>. Each
+   * sample is added at the storage offset given by the dot product of its
+   * indices with precomputed strides, no index tuples are built.
+   *
+   * Samples given as integers list the index of each posterior and then
+   * each conditional variable, i.e. without a slot for \ref given. They can
+   * be passed one by one, as a row major batch of samples or as one array
+   * per variable (columnar).
+   *
+   * @code
+   * counts<X, given, Y> cXgY(X(4) | Y(3));
+   * cXgY.add(X(1) | Y(2));
+   * cXgY.add_samples(samples, n);            // samples[2*k], samples[2*k+1]
+   * cXgY.add_columns({{ xs, ys }}, n);
+   *
+   * distribution<double, X, given, Y> pXgY = cXgY.release();
+   * @endcode
+   *
+   * Accumulators of the same extents can be merged, e.g. after counting
+   * parts of a stream on different threads.
+   */
+  template<typename ...T>
+  class counts
+  {
+  public:
+    typedef distribution<double, T...> distribution_type;
+
+  private:
+    static constexpr size_t P = core::splitter<T...>::posteriors();
+    static constexpr size_t C = core::splitter<T...>::conditionals();
+
+    distribution_type _counts;
+
+    /** @brief Storage stride of each posterior and then each conditional variable */
+    std::array<int, P + C> _strides;
+    std::array<int, P + C> _extents;
+
+    void update_strides()
+    {
+      std::array<int, P> col_extents = core::extent_array(_counts.col_extents());
+      std::array<int, C> row_extents = core::extent_array(_counts.row_extents());
+
+      for(size_t i = 0; i < P; ++i)
+      {
+        _strides[i] = _counts.col_strides()[i] * (int)_counts.colStride();
+        _extents[i] = col_extents[i];
+      }
+
+      for(size_t i = 0; i < C; ++i)
+      {
+        _strides[P + i] = _counts.row_strides()[i] * (int)_counts.rowStride();
+        _extents[P + i] = row_extents[i];
+      }
+    }
+
+    /** @brief Storage offset of a sample */
+    int offset(const int* sample) const
+    {
+      int o = 0;
+      for(size_t i = 0; i < P + C; ++i)
+      {
+        assert(sample[i] >= 0 && sample[i] < _extents[i]);
+        o += sample[i] * _strides[i];
+      }
+      return o;
+    }
+
+  public:
+    /**
+     * @brief Constructor for statically sized random variables
+     */
+    counts()
+    {
+      _counts.setZero();
+      update_strides();
+    }
+
+    /**
+     * @brief Constructor for dynamically sized random variables, takes the
+     * extents as \ref distribution does
+     */
+    template<typename... _T>
+    counts(_T... t) :
+        _counts(t...)
+    {
+      _counts.setZero();
+      update_strides();
+    }
+
+    /** @brief Zero counts with the extents of a distribution */
+    explicit counts(const distribution_type& shape) :
+        _counts(distribution_type::matrix_type::Zero(shape.rows(), shape.cols()),
+            shape.row_extents(), shape.col_extents())
+    {
+      update_strides();
+    }
+
+    /** @brief Add a sample given as random variable objects (e.g. X(1) | Y(2)) */
+    template<typename... _T>
+    void add(_T... t)
+    {
+      _counts.prob_ref(t...) += 1;
+    }
+
+    /**
+     * @brief Add a sample given as the indices of all posterior and
+     * conditional variables
+     */
+    void add(const int* sample, double weight = 1)
+    {
+      _counts.data()[offset(sample)] += weight;
+    }
+
+    /**
+     * @brief Add n samples stored row major, i.e. the indices of the k-th
+     * sample start at samples[k * (P + C)]
+     */
+    void add_samples(const int* samples, size_t n)
+    {
+      double* data = _counts.data();
+      for(size_t k = 0; k < n; ++k)
+        data[offset(samples + k * (P + C))] += 1;
+    }
+
+    /**
+     * @brief Add n samples stored row major with the chunks of samples
+     * counted in parallel on the executor ex
+     *
+     * Each chunk is counted in its own accumulator which is merged into
+     * this one afterwards.
+     */
+    template<typename Executor>
+    void add_samples(const int* samples, size_t n, const Executor& ex)
+    {
+      if(ex.concurrency() < 2)
+      {
+        add_samples(samples, n);
+        return;
+      }
+
+      std::mutex lock;
+      ex.parallel_for(0, int(n), [&] (int begin, int end)
+          {
+            counts local(_counts);
+            local.add_samples(samples + begin * (P + C), end - begin);
+
+            std::lock_guard<std::mutex> guard(lock);
+            merge(local);
+          });
+    }
+
+    /**
+     * @brief Add n samples stored columnar, i.e. the index of variable i in
+     * the k-th sample is columns[i][k]
+     *
+     * Variables are numbered as in add(const int*).
+     */
+    void add_columns(const std::array<const int*, P + C>& columns, size_t n)
+    {
+      double* data = _counts.data();
+      for(size_t k = 0; k < n; ++k)
+      {
+        int o = 0;
+        for(size_t i = 0; i < P + C; ++i)
+        {
+          assert(columns[i][k] >= 0 && columns[i][k] < _extents[i]);
+          o += columns[i][k] * _strides[i];
+        }
+        data[o] += 1;
+      }
+    }
+
+    /** @brief Add the counts of another accumulator of the same extents */
+    void merge(const counts& other)
+    {
+      assert(other._counts.size() == _counts.size());
+
+      Eigen::Map<Eigen::ArrayXd>(_counts.data(), _counts.size()) +=
+          Eigen::Map<const Eigen::ArrayXd>(other._counts.data(), other._counts.size());
+    }
+
+    /** @brief Alias for merge */
+    counts& operator+=(const counts& other)
+    {
+      merge(other);
+      return *this;
+    }
+
+    /** @brief Number of counted samples (sum of all weights) */
+    double total() const
+    {
+      return Eigen::Map<const Eigen::ArrayXd>(_counts.data(), _counts.size()).sum();
+    }
+
+    /** @brief The raw counts */
+    const distribution_type& values() const
+    {
+      return _counts;
+    }
+
+    /** @brief Reset all counts to zero */
+    void clear()
+    {
+      _counts.setZero();
+    }
+
+    /**
+     * @brief The empirical distribution of the counted samples
+     *
+     * The counts are normalized in place and moved into the result,
+     * afterwards the accumulator is empty and needs to be reassigned
+     * before it is used again. Conditional events that were never counted
+     * keep a zero posterior.
+     */
+    distribution_type release()
+    {
+      _counts.normalize();
+      return std::move(_counts);
+    }
+  };
+}
+
+#endif /* _COUNTS_H_ */
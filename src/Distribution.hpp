@@ -2,6 +2,7 @@
 #define _DISTRIBUTION_H_
 
 #include "prob.hpp"
+#include <array>
 #include <utility>
 
 /**
@@ -206,12 +207,67 @@ namespace prob
 						f, std::make_tuple(), extents);
 			}
 
+			template<typename Origin, typename F, typename Executor>
+			void each_index(const Origin& o, F f, const Executor& ex) const
+			{
+				auto extents = util::tuple::concat(
+						util::tuple::append(o._col_extents, 1), o._row_extents);
+				typedef typename std::decay<decltype(std::get<0>(extents))>::type Outer;
+				ex.parallel_for(0, read_index<Outer>::read(std::get<0>(extents)),
+						[&] (int begin, int end)
+						{
+							core::index_iterator<typename Origin::expanded_type>::apply_range(
+									f, extents, begin, end);
+						});
+			}
+
 			template<typename Origin, typename F>
 			void each_conditional_index(const Origin& o, F f) const
 			{
 				core::index_iterator<typename Origin::conditional_type>::apply_all(f,
 						std::make_tuple(), o._row_extents);
 			}
+
+			/** @brief Storage strides of the expanded variables, given has none */
+			template<typename Origin>
+			static typename core::index_iterator<typename Origin::expanded_type>::strides_type
+			storage_strides(const Origin& o)
+			{
+				static constexpr size_t P = Origin::posterior_type::dim;
+				static constexpr size_t C = Origin::conditional_type::dim;
+
+				typename core::index_iterator<typename Origin::expanded_type>::strides_type strides;
+				for(size_t i = 0; i < P; ++i)
+					strides[i] = o._col_strides[i] * (int)o.colStride();
+				strides[P] = 0;
+				for(size_t i = 0; i < C; ++i)
+					strides[P + 1 + i] = o._row_strides[i] * (int)o.rowStride();
+				return strides;
+			}
+
+			template<typename Origin, typename F>
+			void each_index_offset(const Origin& o, F f) const
+			{
+				auto extents = util::tuple::concat(
+						util::tuple::append(o._col_extents, 1), o._row_extents);
+				core::index_iterator<typename Origin::expanded_type>::apply_all_offset(f,
+						extents, storage_strides(o));
+			}
+
+			template<typename Origin, typename F, typename Executor>
+			void each_index_offset(const Origin& o, F f, const Executor& ex) const
+			{
+				auto extents = util::tuple::concat(
+						util::tuple::append(o._col_extents, 1), o._row_extents);
+				auto strides = storage_strides(o);
+				typedef typename std::decay<decltype(std::get<0>(extents))>::type Outer;
+				ex.parallel_for(0, read_index<Outer>::read(std::get<0>(extents)),
+						[&] (int begin, int end)
+						{
+							core::index_iterator<typename Origin::expanded_type>::apply_range_offset(
+									f, extents, strides, begin, end);
+						});
+			}
 		};
 
 		/**
@@ -235,11 +291,54 @@ namespace prob
 						f, std::make_tuple(), o._col_extents);
 			}
 
+			template<typename Origin, typename F, typename Executor>
+			void each_index(const Origin& o, F f, const Executor& ex) const
+			{
+				typedef typename std::decay<decltype(std::get<0>(o._col_extents))>::type Outer;
+				ex.parallel_for(0, read_index<Outer>::read(std::get<0>(o._col_extents)),
+						[&] (int begin, int end)
+						{
+							core::index_iterator<typename Origin::posterior_type>::apply_range(
+									f, o._col_extents, begin, end);
+						});
+			}
+
 			template<typename Origin, typename F>
 			void each_conditional_index(const Origin& o, F f) const
 			{
 				static_assert(true, "Not a conditional distribution");
 			}
+
+			/** @brief Storage strides of the posterior variables */
+			template<typename Origin>
+			static typename core::index_iterator<typename Origin::posterior_type>::strides_type
+			storage_strides(const Origin& o)
+			{
+				typename core::index_iterator<typename Origin::posterior_type>::strides_type strides;
+				for(size_t i = 0; i < strides.size(); ++i)
+					strides[i] = o._col_strides[i] * (int)o.colStride();
+				return strides;
+			}
+
+			template<typename Origin, typename F>
+			void each_index_offset(const Origin& o, F f) const
+			{
+				core::index_iterator<typename Origin::posterior_type>::apply_all_offset(f,
+						o._col_extents, storage_strides(o));
+			}
+
+			template<typename Origin, typename F, typename Executor>
+			void each_index_offset(const Origin& o, F f, const Executor& ex) const
+			{
+				auto strides = storage_strides(o);
+				typedef typename std::decay<decltype(std::get<0>(o._col_extents))>::type Outer;
+				ex.parallel_for(0, read_index<Outer>::read(std::get<0>(o._col_extents)),
+						[&] (int begin, int end)
+						{
+							core::index_iterator<typename Origin::posterior_type>::apply_range_offset(
+									f, o._col_extents, strides, begin, end);
+						});
+			}
 		};
 
 		auto element_index_accu(const std::tuple<random_event, random_event>& t,
@@ -257,8 +356,401 @@ namespace prob
 			return std::make_tuple(lastExtent * curIndex + lastIndex,
 					lastExtent * curExtent);
 		}
+
+		/** @cond PRIVATE */
+		template<size_t I, size_t N>
+		struct stride_builder;
+
+		template<size_t I, size_t N>
+		struct tuple_offset;
+
+		template<bool Conditional, bool Checked, size_t I, typename ...A>
+		struct element_offset;
+		/** @endcond */
+
+		/** @brief Out of bounds check, either reported or asserted on */
+		template<bool Checked>
+		struct bounds_check
+		{
+			static bool valid(int index, int extent)
+			{
+				return index >= 0 && index < extent;
+			}
+		};
+
+		template<>
+		struct bounds_check<false>
+		{
+			static bool valid(int index, int extent)
+			{
+				// Assertion on any out of bounds access
+				assert(index >= 0 && index < extent);
+				return true;
+			}
+		};
+
+		/**
+		 * @brief Builds the strides of a tuple of extents
+		 *
+		 * The last variable is the inner most (stride 1), each other
+		 * stride is the product of all extents to the right of it. The
+		 * products are computed in the value type S of the strides.
+		 */
+		template<size_t I, size_t N>
+		struct stride_builder
+		{
+			template<typename E, typename S>
+			static S build(const E& extents, std::array<S, N>& strides)
+			{
+				S inner = stride_builder<I + 1, N>::build(extents, strides);
+				strides[I] = inner;
+				return inner * S(read_index<random_event>::read(std::get<I>(extents)));
+			}
+		};
+
+		template<size_t N>
+		struct stride_builder<N, N>
+		{
+			template<typename E, typename S>
+			static S build(const E& extents, std::array<S, N>& strides)
+			{
+				return 1;
+			}
+		};
+
+		/** @brief Copies a tuple of extents into an integer array */
+		template<size_t I, size_t N>
+		struct extent_reader
+		{
+			template<typename E>
+			static void read(const E& extents, std::array<int, N>& values)
+			{
+				values[I] = read_index<random_event>::read(std::get<I>(extents));
+				extent_reader<I + 1, N>::read(extents, values);
+			}
+		};
+
+		template<size_t N>
+		struct extent_reader<N, N>
+		{
+			template<typename E>
+			static void read(const E& extents, std::array<int, N>& values)
+			{
+			}
+		};
+
+		/** @brief The extents of a tuple of random events as an integer array */
+		template<typename ...E>
+		std::array<int, sizeof...(E)> extent_array(const std::tuple<E...>& extents)
+		{
+			std::array<int, sizeof...(E)> values;
+			extent_reader<0, sizeof...(E)>::read(extents, values);
+			return values;
+		}
+
+		/** @brief Dot product of an index tuple with the corresponding strides */
+		template<size_t I, size_t N>
+		struct tuple_offset
+		{
+			template<typename Index, typename Extent>
+			static int offset(const Index& index, const Extent& extents,
+					const std::array<int, N>& strides)
+			{
+				int cur = read_index<random_event>::read(std::get<I>(index));
+
+				bounds_check<false>::valid(cur,
+						read_index<random_event>::read(std::get<I>(extents)));
+
+				return cur * strides[I] +
+						tuple_offset<I + 1, N>::offset(index, extents, strides);
+			}
+		};
+
+		template<size_t N>
+		struct tuple_offset<N, N>
+		{
+			template<typename Index, typename Extent>
+			static int offset(const Index& index, const Extent& extents,
+					const std::array<int, N>& strides)
+			{
+				return 0;
+			}
+		};
+
+		/**
+		 * @brief Accumulates row and column offsets directly from packed arguments
+		 *
+		 * Walks the arguments of an element access (e.g. p(a, b | c, d)) and adds
+		 * each index times its stride to either the column (posterior) or the row
+		 * (conditional) offset without building intermediate tuples. In the checked
+		 * variant out of bounds indices are reported by returning false, otherwise
+		 * they are asserted on. Offsets are accumulated in the type of row and
+		 * col (int, or std::int64_t for \ref sparse_distribution).
+		 */
+		template<bool Checked, size_t I, typename Head, typename ...Tail>
+		struct element_offset<false, Checked, I, Head, Tail...>
+		{
+			template<typename D, typename Index>
+			static bool accumulate(const D& d, Index& row, Index& col,
+					const Head& h, const Tail&... t)
+			{
+				int cur = read_index<Head>::read(h);
+				bool valid = bounds_check<Checked>::valid(cur,
+						read_index<random_event>::read(std::get<I>(d._col_extents)));
+				col += cur * d._col_strides[I];
+				return element_offset<false, Checked, I + 1, Tail...>::accumulate(
+						d, row, col, t...) && valid;
+			}
+		};
+
+		template<bool Checked, size_t I, typename Head, typename ...Tail>
+		struct element_offset<true, Checked, I, Head, Tail...>
+		{
+			template<typename D, typename Index>
+			static bool accumulate(const D& d, Index& row, Index& col,
+					const Head& h, const Tail&... t)
+			{
+				int cur = read_index<Head>::read(h);
+				bool valid = bounds_check<Checked>::valid(cur,
+						read_index<random_event>::read(std::get<I>(d._row_extents)));
+				row += cur * d._row_strides[I];
+				return element_offset<true, Checked, I + 1, Tail...>::accumulate(
+						d, row, col, t...) && valid;
+			}
+		};
+
+		template<bool Checked, size_t I, typename ...Tail>
+		struct element_offset<false, Checked, I, given, Tail...>
+		{
+			template<typename D, typename Index>
+			static bool accumulate(const D& d, Index& row, Index& col,
+					const given& g, const Tail&... t)
+			{
+				return element_offset<true, Checked, 0, Tail...>::accumulate(
+						d, row, col, t...);
+			}
+		};
+
+		template<bool Checked, size_t I, typename A, typename B, typename ...Tail>
+		struct element_offset<false, Checked, I, _given<A, B>, Tail...>
+		{
+			template<typename D, typename Index>
+			static bool accumulate(const D& d, Index& row, Index& col,
+					const _given<A, B>& g, const Tail&... t)
+			{
+				return element_offset<false, Checked, I, A>::accumulate(d, row, col, g._a) &&
+						element_offset<true, Checked, 0, B, Tail...>::accumulate(
+								d, row, col, g._b, t...);
+			}
+		};
+
+		template<bool Conditional, bool Checked, size_t I>
+		struct element_offset<Conditional, Checked, I>
+		{
+			template<typename D, typename Index>
+			static bool accumulate(const D& d, Index& row, Index& col)
+			{
+				return true;
+			}
+		};
+
+		/**
+		 * @brief Sets the destination stride of a conditional group index
+		 *
+		 * Only instantiated if the grouped distribution has conditionals,
+		 * without them there are no row strides to index.
+		 */
+		template<bool Conditional>
+		struct grouped_row_axis
+		{
+			template<size_t N, typename D>
+			static void set(std::array<strided_axis, N>& axes, size_t g,
+					const D& grouped_dist, size_t i)
+			{
+				axes[g].dst_stride = grouped_dist.row_strides()[i] *
+						(int)grouped_dist.rowStride();
+			}
+		};
+
+		template<>
+		struct grouped_row_axis<false>
+		{
+			template<size_t N, typename D>
+			static void set(std::array<strided_axis, N>&, size_t, const D&, size_t)
+			{
+			}
+		};
+
+		/**
+		 * @brief Implementation of distribution::grouped_map_sum
+		 *
+		 * Works on any Origin that provides the extents, the strides and the
+		 * Eigen storage accessors of \ref distribution (e.g. also
+		 * \ref mapped_distribution). The result is of the type
+		 * Origin::type_to_distribution gives for the grouped variables.
+		 */
+		template<typename Origin, int... GroupIndices>
+		struct grouped_map_sum_impl
+		{
+			static constexpr size_t P = Origin::posterior_type::dim;
+			static constexpr size_t C = Origin::conditional_type::dim;
+
+			// Are any indices out of range? No permutation of posteriors/conditionals?
+			static_assert(check_indices<P, C, 0, GroupIndices...>::valid(),
+					"Variable index out of range");
+
+			// Allows to select a subset of the types T... given by the
+			// group indices
+			typedef indexed_type_selector<typename Origin::expanded_type,
+					P, C, -1, GroupIndices...> type_selector;
+
+			// Using the type selector we define the result type
+			typedef typename Origin::template type_to_distribution<
+					typename type_selector::result_type>::distribution_type result_type;
+
+			template<typename F, typename Executor>
+			static result_type apply(const Origin& o, F f, const Executor& ex)
+			{
+				// The index splitter splits the group indices between
+				// posteriors and conditionals, the extents of the result are
+				// the subsets of the current row and column extents
+				typename result_type::row_type grouped_row_extents =
+						util::tuple::subset(o.row_extents(), typename
+								index_splitter<typename Origin::row_type, P, C,
+								GroupIndices...>::row_index_type());
+
+				typename result_type::col_type grouped_col_extents =
+						util::tuple::subset(o.col_extents(), typename
+								index_splitter<typename Origin::col_type, P, C,
+								GroupIndices...>::col_index_type());
+
+				result_type grouped_dist;
+				grouped_dist.reshape_dimensions(
+						grouped_row_extents, grouped_col_extents);
+
+				const int group_indices[] = { GroupIndices... };
+
+				// One axis per random variable, with the storage strides in the
+				// origin and the grouped distribution, summed axes have no
+				// grouped stride
+				std::array<strided_axis, P + C> axes;
+
+				std::array<int, P> col_extents = extent_array(o.col_extents());
+				std::array<int, C> row_extents = extent_array(o.row_extents());
+
+				for(size_t i = 0; i < P; ++i)
+					axes[i] = strided_axis { col_extents[i],
+							o.col_strides()[i] * (int)o.colStride(), 0 };
+
+				for(size_t i = 0; i < C; ++i)
+					axes[P + i] = strided_axis { row_extents[i],
+							o.row_strides()[i] * (int)o.rowStride(), 0 };
+
+				// Posterior group indices always precede conditional group indices
+				size_t grouped_posteriors = 0;
+				for(size_t k = 0; k < sizeof...(GroupIndices); ++k)
+				{
+					size_t g = group_indices[k];
+					if(g < P)
+					{
+						axes[g].dst_stride = grouped_dist.col_strides()[k] *
+								(int)grouped_dist.colStride();
+						++grouped_posteriors;
+					}
+					else
+					{
+						grouped_row_axis<(result_type::conditional_type::dim > 0)>::set(
+								axes, g, grouped_dist, k - grouped_posteriors);
+					}
+				}
+
+				// A plain reordering of all variables is a transpose,
+				// otherwise sum over all indices that are not group indices
+				// and apply f to each value
+				if(sizeof...(GroupIndices) == P + C &&
+						std::is_same<F, identity_functor>::value)
+				{
+					strided_copy(o.data(), grouped_dist.data(), axes, ex);
+				}
+				else
+				{
+					grouped_dist.setZero();
+					accumulated_map_sum(o.data(), grouped_dist.data(),
+							grouped_dist.size(), axes, f, ex);
+				}
+
+				return grouped_dist;
+			}
+		};
+
+		/** @cond PRIVATE */
+		template<typename Origin, typename Result,
+		typename OV = typename util::traits::join<vars,
+				typename Origin::posterior_type, typename Origin::conditional_type>::type,
+		typename RP = typename Result::posterior_type,
+		typename RC = typename Result::conditional_type>
+		struct permute_impl;
+		/** @endcond */
+
+		/**
+		 * @brief Implementation of distribution::permute
+		 *
+		 * The extents of the result are picked from the origin by type, the
+		 * cells are moved by a \ref strided_copy.
+		 */
+		template<typename Origin, typename Result, typename ...O, typename ...RP,
+		typename ...RC>
+		struct permute_impl<Origin, Result, vars<O...>, vars<RP...>, vars<RC...>>
+		{
+			static_assert(sizeof...(O) == sizeof...(RP) + sizeof...(RC) &&
+					util::traits::are_distinct<RP..., RC...>::value &&
+					util::traits::contains_all<vars<RP..., RC...>, O...>::value,
+					"A permutation needs to have the same variables");
+
+			template<typename Executor>
+			static Result apply(const Origin& o, const Executor& ex)
+			{
+				static constexpr size_t P = Origin::posterior_type::dim;
+				static constexpr size_t C = Origin::conditional_type::dim;
+
+				auto extents = util::tuple::concat(o.col_extents(), o.row_extents());
+
+				Result result;
+				result.reshape_dimensions(
+						std::make_tuple(std::get<util::traits::type_index<RC, O...>::value>(extents)...),
+						std::make_tuple(std::get<util::traits::type_index<RP, O...>::value>(extents)...));
+
+				// One axis per random variable, with the storage strides in
+				// the origin and the result
+				const int positions[] = { util::traits::type_index<O, RP..., RC...>::value... };
+
+				std::array<strided_axis, P + C> axes;
+				std::array<int, P> col_extents = extent_array(o.col_extents());
+				std::array<int, C> row_extents = extent_array(o.row_extents());
+
+				for(size_t i = 0; i < P + C; ++i)
+				{
+					int k = positions[i];
+					axes[i].extent = i < P ? col_extents[i] : row_extents[i - P];
+					axes[i].src_stride = i < P ?
+							o.col_strides()[i] * (int)o.colStride() :
+							o.row_strides()[i - P] * (int)o.rowStride();
+					axes[i].dst_stride = k < (int)sizeof...(RP) ?
+							result.col_strides()[k] * (int)result.colStride() :
+							result.row_strides()[k - sizeof...(RP)] * (int)result.rowStride();
+				}
+
+				strided_copy(o.data(), result.data(), axes, ex);
+				return result;
+			}
+		};
 	}
 
+	/** @cond PRIVATE */
+	template<typename Scalar, typename ...T>
+	class posterior_view;
+	/** @endcond */
+
 	/**
 	 * @defgroup DIST Probability Distributions
 	 *
@@ -289,34 +781,50 @@ namespace prob
 	 */
 	template<typename Scalar, typename ... T>
 	class distribution: public Eigen::Matrix<Scalar,
-	core::splitter<T...>::conditional_type::eigen_size,
-	core::splitter<T...>::posterior_type::eigen_size>
+	core::storage_size<core::splitter<T...>::conditional_type::eigen_size,
+	core::splitter<T...>::posterior_type::eigen_size>::rows,
+	core::storage_size<core::splitter<T...>::conditional_type::eigen_size,
+	core::splitter<T...>::posterior_type::eigen_size>::cols>
 	{
 	public:
 		/** @brief Access to the scalar type. */
 		typedef Scalar scalar;
 
+		/**
+		 * @brief The type sum, normalize and marginalize accumulate in
+		 * (see #PROB_MIXED_PRECISION)
+		 */
+		typedef typename core::accumulator<Scalar>::type accumulator_type;
+
 		/**
 		 * @brief Eigen base matrix type
 		 *
-		 * The base type of the class, a dynamically sized Eigen::Matrix (matrix or vector). */
+		 * The base type of the class, an Eigen::Matrix (matrix or vector). The matrix
+		 * is fixed size if all random variables are staticly sized and the number of
+		 * cells does not exceed #PROB_MAX_FIXED_SIZE, otherwise it is dynamically sized. */
 		typedef typename Eigen::Matrix<Scalar,
-				core::splitter<T...>::conditional_type::eigen_size,
-				core::splitter<T...>::posterior_type::eigen_size> matrix_type;
+				core::storage_size<core::splitter<T...>::conditional_type::eigen_size,
+				core::splitter<T...>::posterior_type::eigen_size>::rows,
+				core::storage_size<core::splitter<T...>::conditional_type::eigen_size,
+				core::splitter<T...>::posterior_type::eigen_size>::cols> matrix_type;
 
 		/**
 		 * @brief Posterior distribution matrix base type
 		 *
 		 * The base type of the posterior distributions i.e @f$ p(\cdot | y...) @f$. */
 		typedef typename Eigen::Matrix<Scalar, 1,
-				core::splitter<T...>::posterior_type::eigen_size> posterior_matrix_type;
+				core::storage_size<1,
+				core::splitter<T...>::posterior_type::eigen_size>::cols> posterior_matrix_type;
 
 		/**
 		 * The base type of the conditional matrix. This type does not represent a
 		 * concept from probability theory and is mainly used internally.
 		 */
 		typedef typename Eigen::Matrix<Scalar,
-				core::splitter<T...>::posterior_type::eigen_size, 1> conditional_matrix_type;
+				core::storage_size<core::splitter<T...>::posterior_type::eigen_size,
+				1>::rows, 1> conditional_matrix_type;
+
+		EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
 		/**
 		 * @brief Row extents/indices tuple type
@@ -336,6 +844,24 @@ namespace prob
 		 */
 		typedef typename core::splitter<T...>::posterior_type::index_type col_type;
 
+		/**
+		 * @brief Row strides type
+		 *
+		 * The strides of the conditional variables within a column of the
+		 * backing matrix, i.e. the row of an event is the dot product of its
+		 * conditional indices with the row strides.
+		 */
+		typedef std::array<int, core::splitter<T...>::conditional_type::dim> row_strides_type;
+
+		/**
+		 * @brief Column strides type
+		 *
+		 * The strides of the posterior variables within a row of the
+		 * backing matrix, i.e. the column of an event is the dot product of its
+		 * posterior indices with the column strides.
+		 */
+		typedef std::array<int, core::splitter<T...>::posterior_type::dim> col_strides_type;
+
 
 		/**
 		 * @brief Conditional variables type type
@@ -388,17 +914,107 @@ namespace prob
 		typedef typename type_to_distribution<conditional_type>::distribution_type
 				conditional_distribution_type;
 
+		/** @cond PRIVATE */
+		template<typename _T>
+		struct type_to_view;
+
+		template<typename ..._T, template<typename ...> class U>
+		struct type_to_view<U<_T...>>
+		{
+			typedef prob::posterior_view<Scalar, _T...> view_type;
+		};
+		/** @endcond */
+
+		/**
+		 * @brief Read only view type of the posterior distributions
+		 * (see \ref prob::posterior_view)
+		 */
+		typedef typename type_to_view<posterior_type>::view_type posterior_view_type;
+
 	private:
 
 		static constexpr bool _conditional_distribution =
 				core::splitter<T...>::conditional_distribution;
 
 		template <bool> friend struct core::conditional_case;
+		template <bool, bool, size_t, typename...> friend struct core::element_offset;
 		core::conditional_case<_conditional_distribution> cased;
 
 		row_type _row_extents;
 		col_type _col_extents;
 
+		row_strides_type _row_strides;
+		col_strides_type _col_strides;
+
+		/** @brief Recalculate the strides after the extents changed */
+		void update_strides()
+		{
+			core::stride_builder<0, conditional_type::dim>::build(_row_extents, _row_strides);
+			core::stride_builder<0, posterior_type::dim>::build(_col_extents, _col_strides);
+		}
+
+		/** @brief View of the posterior distribution in row i */
+		posterior_view_type posterior_row(int i) const
+		{
+			return posterior_view_type(matrix_type::data() + i * matrix_type::rowStride(),
+					matrix_type::cols(), matrix_type::colStride(), _col_extents, _col_strides);
+		}
+
+		/** @brief Read the header and buffer of the binary format */
+		bool read_binary(std::istream& in)
+		{
+			static constexpr size_t P = core::splitter<T...>::posteriors();
+
+			core::binary_header header;
+			if(!header.read(in, posterior_type::dim + conditional_type::dim) ||
+					!header.template matches<posterior_type, conditional_type>() ||
+					!header.consistent_extents())
+				return false;
+
+			row_type row_extents = core::extent_tuple<row_type>::build(header.extents.data() + P);
+			col_type col_extents = core::extent_tuple<col_type>::build(header.extents.data());
+
+			if(extents_assert<T...>::is_static())
+			{
+				if(core::extent_array(row_extents) != core::extent_array(_row_extents) ||
+						core::extent_array(col_extents) != core::extent_array(_col_extents))
+					return false;
+			}
+			else
+			{
+				reshape_dimensions(row_extents, col_extents);
+			}
+
+			if(header.rows != std::uint64_t(this->rows()) ||
+					header.cols != std::uint64_t(this->cols()))
+				return false;
+
+			static constexpr bool RowMajor = matrix_type::IsRowMajor;
+
+			if(header.kind == 'f' && header.scalar_size == sizeof(float))
+				return core::binary_read_matrix<float, RowMajor>(in, this->data(),
+						this->rows(), this->cols(), header.row_major);
+			if(header.kind == 'f' && header.scalar_size == sizeof(double))
+				return core::binary_read_matrix<double, RowMajor>(in, this->data(),
+						this->rows(), this->cols(), header.row_major);
+			if(header.kind == core::binary_scalar_kind<Scalar>() &&
+					header.scalar_size == sizeof(Scalar))
+				return core::binary_read_matrix<Scalar, RowMajor>(in, this->data(),
+						this->rows(), this->cols(), header.row_major);
+
+			return false;
+		}
+
+		/** @brief Row and column of an element given as packed arguments */
+		template<bool Checked, typename... _T>
+		bool element_position(int& row, int& col, const _T&... t) const
+		{
+			row = 0;
+			col = 0;
+			return core::element_offset<false, Checked, 0,
+					typename std::decay<_T>::type...>::accumulate(*this, row, col, t...);
+		}
+
 	public:
 
 		/**
@@ -466,6 +1082,56 @@ namespace prob
 			return dist;
     }
 
+		/**
+		 * @brief Save the distribution in the binary format
+		 *
+		 * Writes a header (labels and extents of the random variables, scalar
+		 * type and storage layout) followed by the backing matrix as one raw
+		 * buffer. See \ref Serialization.hpp for the format.
+		 */
+		void save_binary(std::ostream& out) const
+		{
+			std::array<int, posterior_type::dim> col_extents = core::extent_array(_col_extents);
+			std::array<int, conditional_type::dim> row_extents = core::extent_array(_row_extents);
+
+			core::binary_header header;
+			header.kind = core::binary_scalar_kind<Scalar>();
+			header.scalar_size = sizeof(Scalar);
+			header.row_major = matrix_type::IsRowMajor ? 1 : 0;
+			header.posteriors = posterior_type::dim;
+			header.conditionals = conditional_type::dim;
+			header.labels = core::type_labels<posterior_type>::labels();
+			for(const std::string& l : core::type_labels<conditional_type>::labels())
+				header.labels.push_back(l);
+			header.extents.assign(col_extents.begin(), col_extents.end());
+			header.extents.insert(header.extents.end(), row_extents.begin(), row_extents.end());
+			header.rows = this->rows();
+			header.cols = this->cols();
+
+			header.write(out);
+			out.write(reinterpret_cast<const char*>(this->data()),
+					std::streamsize(this->size()) * sizeof(Scalar));
+		}
+
+		/**
+		 * @brief Load a distribution saved by save_binary
+		 *
+		 * The header is checked against the type of the distribution, the
+		 * values are read with a single bulk read. Files with another
+		 * floating point scalar type or storage layout are converted.
+		 *
+		 * If the file cannot be read, or does not match the random variables
+		 * of the distribution, the failbit of in is set and an empty
+		 * distribution is returned.
+		 */
+		static distribution<Scalar, T...> load_binary(std::istream& in)
+		{
+			distribution<Scalar, T...> dist;
+			if(!dist.read_binary(in))
+				in.setstate(std::ios::failbit);
+			return dist;
+		}
+
 		/**
 		 * @brief Default constructor
 		 *
@@ -476,11 +1142,15 @@ namespace prob
 		 *
 		 * @todo Some way to assert any illicit usage?
 		 */
-		distribution() : matrix_type(core::static_row_extents<T...>::size(),
-				core::static_col_extents<T...>::size()),
+		distribution() : matrix_type(),
 				_row_extents(core::static_row_extents<T...>::extents()),
 				_col_extents(core::static_col_extents<T...>::extents())
 		{
+			// Sized in the body, fixed size vectors of size two would otherwise
+			// interpret the extents as coefficients
+			matrix_type::resize(core::static_row_extents<T...>::size(),
+					core::static_col_extents<T...>::size());
+			update_strides();
 		}
 
 		/**
@@ -488,8 +1158,24 @@ namespace prob
 		 */
 		distribution(const distribution<Scalar, T...>& other) :
 			matrix_type(other),
-			_row_extents(other.row_extents()),
-			_col_extents(other.col_extents())
+			_row_extents(other._row_extents),
+			_col_extents(other._col_extents),
+			_row_strides(other._row_strides),
+			_col_strides(other._col_strides)
+		{
+		}
+
+		/**
+		 * @brief Move constructor
+		 *
+		 * Takes over the buffer of a dynamically sized backing matrix.
+		 */
+		distribution(distribution<Scalar, T...>&& other) :
+			matrix_type(std::move(static_cast<matrix_type&>(other))),
+			_row_extents(other._row_extents),
+			_col_extents(other._col_extents),
+			_row_strides(other._row_strides),
+			_col_strides(other._col_strides)
 		{
 		}
 
@@ -522,6 +1208,8 @@ namespace prob
 							1,
 							col_extents);
 			assert(other.cols() == induced_cols);
+
+			update_strides();
 		}
 
 		/**
@@ -561,6 +1249,8 @@ namespace prob
 			// does not match _T... (expanded type)
 			static_assert(util::traits::are_equivalent<typename local_splitter::expanded_type, T...>::value,
 					"Random variable type mismatch");
+
+			update_strides();
 		}
 
 		distribution& operator=(const distribution &other)
@@ -569,8 +1259,23 @@ namespace prob
 				return *this;
 
 			matrix_type::operator=(other);
-			_row_extents = other.row_extents();
-			_col_extents = other.col_extents();
+			_row_extents = other._row_extents;
+			_col_extents = other._col_extents;
+			_row_strides = other._row_strides;
+			_col_strides = other._col_strides;
+			return *this;
+		}
+
+		distribution& operator=(distribution &&other)
+		{
+			if(&other == this)
+				return *this;
+
+			matrix_type::operator=(std::move(static_cast<matrix_type&>(other)));
+			_row_extents = other._row_extents;
+			_col_extents = other._col_extents;
+			_row_strides = other._row_strides;
+			_col_strides = other._col_strides;
 			return *this;
 		}
 
@@ -584,6 +1289,11 @@ namespace prob
 		/** @brief Alias for posterior_extents */
 		col_type col_extents() const { return _col_extents; }
 
+		/** @brief Strides of the conditional variables (see \ref row_strides_type) */
+		const row_strides_type& row_strides() const { return _row_strides; }
+		/** @brief Strides of the posterior variables (see \ref col_strides_type) */
+		const col_strides_type& col_strides() const { return _col_strides; }
+
 
 		/** @brief Extent of the i-th conditional variable */
 		template<size_t i>
@@ -656,6 +1366,7 @@ namespace prob
 				this->resize(rows, cols);
 				_row_extents = new_row_extents;
 				_col_extents = new_col_extents;
+				update_strides();
 			}
 		}
 
@@ -703,6 +1414,7 @@ namespace prob
 			// Update the distribution
 			_row_extents = new_row_extents;
 			_col_extents = new_col_extents;
+			update_strides();
 
 			this->resize(rows, cols);
 			this->setZero();
@@ -733,56 +1445,10 @@ namespace prob
 					typename local_splitter::expanded_type, T...>::value,
 					"Random variable type mismatch");
 
-			// Get the conditional indices of the arguments
-			row_type row_index(
-					local_splitter::row_index(
-							std::forward<typename std::decay<_T>::type>(t)...));
-
-			// Get the posterior indices of the arguments
-			col_type col_index(
-					local_splitter::col_index(
-							std::forward<typename std::decay<_T>::type>(t)...));
-
 			int row, col;
-			bool out_of_bounds=false;
-
-			// Fold accumulator that creates the row, column index from the
-			// conditional/posterior indices and extents this check for out of bounds
-			// access
-			auto f = [&out_of_bounds] (const std::tuple<random_event, random_event>& t,
-					std::tuple<int,int> u)
-					-> std::tuple<int,int>
-			{
-				// Get the accumulated index and extent
-				int lastExtent = std::get<1>(u);
-				int lastIndex = std::get<0>(u);
-				// Get the index and extent of the next random variable
-				int curExtent = read_index<random_event>::read(std::get<1>(t));
-				int curIndex = read_index<random_event>::read(std::get<0>(t));
-
-				// Assertion on any out of bounds access
-				if(curIndex < 0 || curIndex >= curExtent)
-					out_of_bounds = true;
-
-				// Return the accumulated index and extent
-				return std::make_tuple(
-						lastExtent * curIndex + lastIndex,
-						lastExtent * curExtent);
-			};
-
-			// Use f to calculate row and column index
-			row = std::get<0>(util::tuple::fold(
-					f,
-					std::make_tuple(0,1),
-					util::tuple::zip(row_index,_row_extents)));
-
-			col = std::get<0>(util::tuple::fold(
-					f,
-					std::make_tuple(0,1),
-					util::tuple::zip(col_index,_col_extents)));
 
 			// Out of bounds reads a 0
-			if(out_of_bounds)
+			if(!element_position<true>(row, col, t...))
 				return Scalar(0);
 
 			return matrix_type::operator()(row,col);
@@ -797,18 +1463,11 @@ namespace prob
 		 */
 		Scalar& prob_ref_via_tuple(const row_type& row_index, const col_type& col_index)
 		{
-			int row, col;
-
-			// Use the default accumulator to calculate row and column index
-			row = std::get<0>(util::tuple::fold(
-					core::element_index_accu,
-					std::make_tuple(0,1),
-					util::tuple::zip(row_index,_row_extents)));
-
-			col = std::get<0>(util::tuple::fold(
-					core::element_index_accu,
-					std::make_tuple(0,1),
-					util::tuple::zip(col_index,_col_extents)));
+			// Dot product of the indices and the strides
+			int row = core::tuple_offset<0, conditional_type::dim>::offset(
+					row_index, _row_extents, _row_strides);
+			int col = core::tuple_offset<0, posterior_type::dim>::offset(
+					col_index, _col_extents, _col_strides);
 
 			return matrix_type::operator()(row,col);
 		}
@@ -820,20 +1479,13 @@ namespace prob
 		 * @param row_index The index tuple of the posterior events
 		 * @returns Reference to the probability
 		 */
-		Scalar prob_via_tuple(const row_type& row_index, const col_type& col_index)
+		Scalar prob_via_tuple(const row_type& row_index, const col_type& col_index) const
 		{
-			int row, col;
-
-			// Use the default accumulator to calculate row and column index
-			row = std::get<0>(util::tuple::fold(
-					core::element_index_accu,
-					std::make_tuple(0,1),
-					util::tuple::zip(row_index,_row_extents)));
-
-			col = std::get<0>(util::tuple::fold(
-					core::element_index_accu,
-					std::make_tuple(0,1),
-					util::tuple::zip(col_index,_col_extents)));
+			// Dot product of the indices and the strides
+			int row = core::tuple_offset<0, conditional_type::dim>::offset(
+					row_index, _row_extents, _row_strides);
+			int col = core::tuple_offset<0, posterior_type::dim>::offset(
+					col_index, _col_extents, _col_strides);
 
 			return matrix_type::operator()(row,col);
 		}
@@ -856,28 +1508,10 @@ namespace prob
 					typename local_splitter::expanded_type, T...>::value,
 					"Random variable type mismatch");
 
-			// Get the conditional indices of the arguments
-			row_type row_index(
-					local_splitter::row_index(
-							std::forward<typename std::decay<_T>::type>(t)...));
-
-			// Get the posterior indices of the arguments
-			col_type col_index(
-					local_splitter::col_index(
-							std::forward<typename std::decay<_T>::type>(t)...));
-
 			int row, col;
 
-			// Use the default accumulator to calculate row and column index
-			row = std::get<0>(util::tuple::fold(
-					core::element_index_accu,
-					std::make_tuple(0,1),
-					util::tuple::zip(row_index,_row_extents)));
-
-			col = std::get<0>(util::tuple::fold(
-					core::element_index_accu,
-					std::make_tuple(0,1),
-					util::tuple::zip(col_index,_col_extents)));
+			// Accumulate row and column directly from the arguments and strides
+			element_position<false>(row, col, t...);
 
 			return matrix_type::operator()(row,col);
 		}
@@ -900,28 +1534,10 @@ namespace prob
 					typename local_splitter::expanded_type, T...>::value,
 					"Random variable type mismatch");
 
-			// Get the conditional indices of the arguments
-			row_type row_index(
-					local_splitter::row_index(
-							std::forward<typename std::decay<_T>::type>(t)...));
-
-			// Get the posterior indices of the arguments
-			col_type col_index(
-					local_splitter::col_index(
-							std::forward<typename std::decay<_T>::type>(t)...));
-
 			int row, col;
 
-			// Use the default accumulator to calculate row and column index
-			row = std::get<0>(util::tuple::fold(
-					core::element_index_accu,
-					std::make_tuple(0,1),
-					util::tuple::zip(row_index,_row_extents)));
-
-			col = std::get<0>(util::tuple::fold(
-					core::element_index_accu,
-					std::make_tuple(0,1),
-					util::tuple::zip(col_index,_col_extents)));
+			// Accumulate row and column directly from the arguments and strides
+			element_position<false>(row, col, t...);
 
 			return matrix_type::operator()(row,col);
 		}
@@ -956,22 +1572,43 @@ namespace prob
 
 			static_assert(_conditional_distribution, "Not a conditional distribution");
 
-			// The row index does not need to be extracted here, we just make a tuple
-			row_type row_index = std::make_tuple(t...);
-
-			int row;
+			int row = 0, col = 0;
 
-			// Again fold index and extents
-			row = std::get<0>(util::tuple::fold(
-					core::element_index_accu,
-					std::make_tuple(0,1),
-					util::tuple::zip(row_index,_row_extents)));
+			// Only conditional indices are supplied
+			core::element_offset<true, false, 0, typename std::decay<_T>::type...>::accumulate(
+					*this, row, col, t...);
 
 			// Return the row of the matrix as the posterior distribution type with
 			// corresponding extents
 			return posterior_distribution_type(matrix_type::row(row), std::make_tuple<>(), _col_extents);
 		}
 
+		/**
+		 * @brief Get a read only view of a conditioned posterior distribution
+		 *
+		 * Same as posterior_distribution but the row is not copied, see
+		 * \ref prob::posterior_view.
+		 *
+		 * @param t... Conditional indices  @f$ y... @f$
+		 * @returns View of the posterior distribution @f$ p(\cdot | y...) @f$
+		 */
+		template<typename... _T>
+		posterior_view_type posterior_view(_T&& ... t) const
+		{
+			static_assert(util::traits::are_equivalent<conditional_type,
+					typename std::decay<_T>::type...>::value,
+					"Random variable type mismatch");
+
+			static_assert(_conditional_distribution, "Not a conditional distribution");
+
+			int row = 0, col = 0;
+
+			core::element_offset<true, false, 0, typename std::decay<_T>::type...>::accumulate(
+					*this, row, col, t...);
+
+			return posterior_row(row);
+		}
+
 		/**
 		 * @brief Iterate over all variable indices
 		 *
@@ -1000,6 +1637,77 @@ namespace prob
 			cased.each_index(*this,f);
 		}
 
+		/**
+		 * @brief Iterate over all variable indices on an executor
+		 *
+		 * Same as each_index, but the range of the outer most variable is split
+		 * into contiguous chunks which are processed by the executor (see
+		 * Parallel.hpp). Within a chunk the indices are visited in the same
+		 * order as by each_index.
+		 *
+		 * The function f is shared by all threads and must be safe to call
+		 * concurrently. In particular f may only write to the cells addressed
+		 * by its own index (e.g. through prob_ref(t...)), or to storage that
+		 * is otherwise private to that index.
+		 *
+		 * @tparam F function type
+		 * @param f the function.
+		 * @param ex The executor, e.g. a \ref thread_pool
+		 */
+		template<typename F, typename Executor>
+		void each_index(F f, const Executor& ex) const
+		{
+			cased.each_index(*this, f, ex);
+		}
+
+		/**
+		 * @brief each_index on a given number of freshly spawned threads
+		 *
+		 * @param f the function, see each_index(F, const Executor&)
+		 * @param threads Maximal number of threads, 0 uses all hardware threads
+		 */
+		template<typename F>
+		void parallel_each_index(F f, unsigned threads = 0) const
+		{
+			each_index(f, core::thread_spawner(threads));
+		}
+
+		/**
+		 * @brief Iterate over all variable indices together with the position
+		 * of each cell in the backing buffer
+		 *
+		 * Same as each_index, but calls f(offset, t...) where
+		 * data()[offset] holds the probability of t..., hence f can read or
+		 * write the buffer directly:
+		 *
+		 * @code
+		 * distribution<double, X, given, Y> p;
+		 * double* values = p.data();
+		 * p.each_index_offset([&] (int offset, const X& x, given, const Y& y)
+		 *               {
+		 *                 values[offset] = f(x, y);
+		 *               });
+		 * @endcode
+		 *
+		 * @tparam F function type
+		 * @param f the function.
+		 */
+		template<typename F>
+		void each_index_offset(F f) const
+		{
+			cased.each_index_offset(*this, f);
+		}
+
+		/**
+		 * @brief each_index_offset on an executor, see
+		 * each_index(F, const Executor&) for the requirements on f
+		 */
+		template<typename F, typename Executor>
+		void each_index_offset(F f, const Executor& ex) const
+		{
+			cased.each_index_offset(*this, f, ex);
+		}
+
 		/**
 		 * @brief Iterate over all variable indices with reversed loops
 		 *
@@ -1046,17 +1754,69 @@ namespace prob
 			cased.each_conditional_index(*this,f);
 		}
 
+		/**
+		 * @brief Call f(p) with a read only view p of each posterior
+		 * distribution @f$ p(\cdot | y...) @f$
+		 *
+		 * The posteriors are visited in the order of each_conditional_index,
+		 * nothing is copied (see \ref prob::posterior_view).
+		 */
+		template<typename F>
+		void each_posterior(F f) const
+		{
+			static_assert(_conditional_distribution, "Not a conditional distribution");
+
+			for(int i = 0; i < matrix_type::rows(); ++i)
+				f(posterior_row(i));
+		}
+
+		/**
+		 * @brief Call f(p) with a read only view p of each posterior
+		 * distribution, the posteriors are distributed over the executor
+		 */
+		template<typename F, typename Executor>
+		void each_posterior(F f, const Executor& ex) const
+		{
+			static_assert(_conditional_distribution, "Not a conditional distribution");
+
+			ex.parallel_for(0, matrix_type::rows(),
+					[&] (int begin, int end)
+					{
+						for(int i = begin; i < end; ++i)
+							f(posterior_row(i));
+					});
+		}
+
 		/**
 		 * @brief Normalize the distribution
+		 *
+		 * The rows (i.e. the conditional events) are distributed over the
+		 * executor.
 		 */
-		void normalize()
+		template<typename Executor = serial_executor>
+		void normalize(const Executor& ex = Executor())
 		{
-			for(unsigned i=0;i<matrix_type::rows();++i)
-			{
-				Scalar sum_value = matrix_type::row(i).sum();
-				if(sum_value > 0)
-					matrix_type::row(i).operator/=(sum_value);
-			}
+			ex.parallel_for(0, matrix_type::rows(),
+					[this] (int begin, int end)
+					{
+						for(int i=begin;i<end;++i)
+						{
+							accumulator_type sum_value =
+									matrix_type::row(i).template cast<accumulator_type>().sum();
+							if(sum_value > 0)
+								matrix_type::row(i).operator/=(Scalar(sum_value));
+						}
+					});
+		}
+
+		/**
+		 * @brief normalize on a given number of freshly spawned threads
+		 *
+		 * @param threads Maximal number of threads, 0 uses all hardware threads
+		 */
+		void parallel_normalize(unsigned threads = 0)
+		{
+			normalize(core::thread_spawner(threads));
 		}
 
 		/**
@@ -1068,7 +1828,7 @@ namespace prob
 		 */
 		Scalar sum()
 		{
-			return matrix_type::sum();
+			return Scalar(matrix_type::template cast<accumulator_type>().sum());
 		};
 
 		/**
@@ -1081,7 +1841,8 @@ namespace prob
 		 */
 		conditional_distribution_type sum_by_conditional()
 		{
-			auto summed_matrix =  matrix_type::rowwise().sum();
+			auto summed_matrix = matrix_type::template cast<accumulator_type>()
+					.rowwise().sum().template cast<Scalar>();
 			return conditional_distribution_type(summed_matrix.transpose(), std::make_tuple<>(), _row_extents);
 		};
 
@@ -1089,18 +1850,36 @@ namespace prob
 		 * @brief Apply a function to each probability value
 		 *
 		 * The function f only gets the probabilities not the indices.
-		 * This method returns the mutated distribution.
+		 * This method returns the mutated distribution. The storage is
+		 * split into chunks processed by the executor, f must be safe to
+		 * call concurrently unless the executor is serial.
 		 */
-		template<typename F>
-		distribution& map(F&& f)
+		template<typename F, typename Executor = serial_executor>
+		distribution& map(F&& f, const Executor& ex = Executor())
 		{
-			for(unsigned i=0;i<matrix_type::rows();++i)
-				for(unsigned j=0;j<matrix_type::cols();++j)
-					matrix_type::operator()(i,j) = f(matrix_type::operator()(i,j));
+			Scalar* values = matrix_type::data();
+			ex.parallel_for(0, matrix_type::size(),
+					[values, &f] (int begin, int end)
+					{
+						for(int i=begin;i<end;++i)
+							values[i] = f(values[i]);
+					});
 
 			return *this;
 		}
 
+		/**
+		 * @brief map on a given number of freshly spawned threads
+		 *
+		 * @param f The map, any callable Scalar -> Scalar
+		 * @param threads Maximal number of threads, 0 uses all hardware threads
+		 */
+		template<typename F>
+		distribution& parallel_map(F&& f, unsigned threads = 0)
+		{
+			return map(f, core::thread_spawner(threads));
+		}
+
 		/**
 		 * @brief Apply a function to a copy of each probability value
 		 *
@@ -1110,13 +1889,29 @@ namespace prob
 		template<typename F>
 		distribution map_copy(F&& f) const
 		{
-			matrix_type mapped(matrix_type::rows(),matrix_type::cols());
+			matrix_type mapped;
+			mapped.resize(matrix_type::rows(),matrix_type::cols());
 			for(unsigned i=0;i<matrix_type::rows();++i)
 				for(unsigned j=0;j<matrix_type::cols();++j)
 					mapped(i,j) = f(matrix_type::operator()(i,j));
 			return distribution(mapped, _row_extents, _col_extents);
 		}
 
+		/**
+		 * @brief Copy of the distribution with another scalar type
+		 *
+		 * E.g. the conversion to and from \ref logspace probabilities:
+		 * @code
+		 * distribution<logspace<double>, X, Y> lXY = pXY.scalar_cast<logspace<double>>();
+		 * @endcode
+		 */
+		template<typename NewScalar>
+		distribution<NewScalar, T...> scalar_cast() const
+		{
+			return distribution<NewScalar, T...>(
+					matrix_type::template cast<NewScalar>(), _row_extents, _col_extents);
+		}
+
 		/**
 		 * @brief Apply a function to each posterior distribution
 		 *
@@ -1145,7 +1940,8 @@ namespace prob
 		template<typename F>
 		distribution map_copy_by_conditional(F&& f) const
 		{
-			matrix_type mapped(matrix_type::rows(), matrix_type::cols());
+			matrix_type mapped;
+			mapped.resize(matrix_type::rows(), matrix_type::cols());
 			for(unsigned i=0;i<matrix_type::rows();++i)
 			{
 				mapped.row(i) =
@@ -1168,101 +1964,24 @@ namespace prob
 		 * where @f$ x_* ... @f$ denotes the merge of the summation indices and the
 		 * selection indices @f$ i_0,...,i_m @f$.
 		 *
+		 * The sum runs directly on the backing matrices, using the strides of
+		 * both distributions (see \ref core::strided_map_sum).
+		 *
+		 * The non grouped axes are split across the executor ex.
+		 *
+		 * @tparam F Type of the map, any callable Scalar -> Scalar
 		 */
-		template<int... GroupIndices>
-		auto grouped_map_sum(std::function<Scalar(Scalar)> f) const  ->
-		typename type_to_distribution<
-		typename core::indexed_type_selector<expanded_type,
-		core::splitter<T...>::posteriors(),
-		core::splitter<T...>::conditionals(),
-		-1,
-		GroupIndices...>::result_type>::distribution_type
+		template<int... GroupIndices, typename F, typename Executor = serial_executor>
+		auto grouped_map_sum(F f, const Executor& ex = Executor()) const  ->
+		typename core::grouped_map_sum_impl<distribution, GroupIndices...>::result_type
 		{
-			// Are any indices out of range? No permutation of posteriors/conditionals?
-			static_assert(core::check_indices<
-					core::splitter<T...>::posteriors(),
-					core::splitter<T...>::conditionals(),
-					0,
-					GroupIndices...>::valid(), "Variable index out of range");
-
-			// Allows to select a subset of the types T... given by the
-			// group indices
-			typedef typename core::indexed_type_selector<
-					expanded_type,
-					core::splitter<T...>::posteriors(),
-					core::splitter<T...>::conditionals(),
-					-1,
-					GroupIndices...> type_selector;
-
-			// Using the type selector we define the result type
-			typedef typename type_to_distribution<typename type_selector::result_type>
-			::distribution_type result_type;
-
-			// First we determine the row (conditional) extents
-			// of the result type, by selecting a subset
-			// of the current row extents
-
-			// The index splitter splits the group indices
-			// between posteriors and conditionals
-			typename result_type::row_type grouped_row_extents =
-					util::tuple::subset(_row_extents,
-							typename
-							core::index_splitter<row_type,
-							core::splitter<T...>::posteriors(),
-							core::splitter<T...>::conditionals(),
-							GroupIndices...>::row_index_type());
-
-			/*
-			// Then calculate the number of rows of the grouped distribution
-			int grouped_rows =
-					util::tuple::fold(
-							[] (const random_event &a, int b)
-							{ return a._val*b; },
-							1,
-							grouped_row_extents);*/
-
-			// Now we determine the column (posterior) extents
-			// of the result type, by selecting a subset
-			// of the current column extents
-			typename result_type::col_type grouped_col_extents =
-					util::tuple::subset(_col_extents,
-							typename
-							core::index_splitter<col_type,
-							core::splitter<T...>::posteriors(),
-							core::splitter<T...>::conditionals(),
-							GroupIndices...>::col_index_type());
-			/*
-			// And calculate the number of cols of the grouped distribution
-			int grouped_cols =
-					util::tuple::fold(
-							[] (const random_event &a, int b)
-							{ return a._val*b; },
-							1,
-							grouped_col_extents);*/
-
-			result_type grouped_dist;
-			grouped_dist.reshape_dimensions(
-					grouped_row_extents, grouped_col_extents);
-
-			grouped_dist.setZero();
-
-			// Finally sum over all indices that are not group indices
-			// and apply f to each value
-			this->each_index(
-					[this, &grouped_dist, &f] (const T&... t)
-					{
-				core::ref<
-				typename type_selector::index_type,
-				double,result_type, T...>::get(grouped_dist, t...) +=
-						f(this->operator()(std::forward<const T&>(t)...));
-					});
-
-			return grouped_dist;
+			return core::grouped_map_sum_impl<distribution, GroupIndices...>::apply(
+					*this, f, ex);
 		}
 
 		/** @brief grouped_map_sum with f being the identity */
-		template<int... GroupIndices>
-		auto grouped_sum() const ->
+		template<int... GroupIndices, typename Executor = serial_executor>
+		auto grouped_sum(const Executor& ex = Executor()) const ->
 		typename type_to_distribution<
 		typename core::indexed_type_selector<expanded_type,
 		core::splitter<T...>::posteriors(),
@@ -1270,13 +1989,12 @@ namespace prob
 		-1,
 		GroupIndices...>::result_type>::distribution_type
 		{
-			auto id = [] (Scalar i) { return i; };
-			return grouped_map_sum<GroupIndices...>(id);
+			return grouped_map_sum<GroupIndices...>(core::identity_functor(), ex);
 		}
 
 		/** @brief Alias for grouped_sum */
-		template<int... GroupIndices>
-		auto marginalize() const ->
+		template<int... GroupIndices, typename Executor = serial_executor>
+		auto marginalize(const Executor& ex = Executor()) const ->
 		typename type_to_distribution<
 		typename core::indexed_type_selector<expanded_type,
 		core::splitter<T...>::posteriors(),
@@ -1284,8 +2002,32 @@ namespace prob
 		-1,
 		GroupIndices...>::result_type>::distribution_type
 		{
-			auto id = [] (Scalar i) { return i; };
-			return grouped_map_sum<GroupIndices...>(id);
+			return grouped_map_sum<GroupIndices...>(core::identity_functor(), ex);
+		}
+
+		/**
+		 * @brief The same table with the random variables reordered
+		 *
+		 * U... is any order of the variables T..., variables are matched by
+		 * type and may move across \ref given, e.g.
+		 * @code
+		 * distribution<double, X, Y> pXY;
+		 * distribution<double, Y, X> pYX = pXY.permute<Y, X>();
+		 * distribution<double, Y, given, X> tYX = pXY.permute<Y, given, X>();
+		 * @endcode
+		 * The latter has the cells p(x, y) in the rows x, i.e. is not
+		 * normalized as a conditional distribution. The cells are copied
+		 * by a tiled transpose of the backing matrix, see
+		 * \ref core::strided_copy.
+		 *
+		 * @tparam U... The variables of the result
+		 * @param ex Executor the copy is distributed over
+		 */
+		template<typename ...U, typename Executor = serial_executor>
+		distribution<Scalar, U...> permute(const Executor& ex = Executor()) const
+		{
+			return core::permute_impl<distribution,
+					distribution<Scalar, U...>>::apply(*this, ex);
 		}
 
 		/** @brief Returns a histogram as ASCII art in the given dimensions */
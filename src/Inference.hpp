@@ -0,0 +1,494 @@
+#ifndef _INFERENCE_H_
+#define _INFERENCE_H_
+
+#include <algorithm>
+#include <list>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @file Inference.hpp
+ *
+ * @brief Marginals of products of many distributions by variable elimination
+ */
+
+namespace prob
+{
+  namespace core
+  {
+    /** @brief An address that is unique to the random variable type T */
+    template<typename T>
+    const void* variable_key()
+    {
+      static const char key = 0;
+      return &key;
+    }
+
+    /**
+     * @brief A table over variables of a \ref factor_graph
+     *
+     * The cell of an assignment is at the dot product of the indices of
+     * the variables with the strides.
+     */
+    template<typename Scalar>
+    struct factor
+    {
+      std::vector<int> variables;
+      std::vector<int> strides;
+      std::vector<Scalar> values;
+
+      /**
+       * @brief Number of leading posterior variables, a factor sums to one
+       * over its posteriors (0 for intermediate factors)
+       */
+      size_t posteriors;
+
+      /** @brief Stride of a variable, 0 if the factor does not depend on it */
+      int stride(int v) const
+      {
+        for(size_t i = 0; i < variables.size(); ++i)
+          if(variables[i] == v)
+            return strides[i];
+        return 0;
+      }
+
+      bool contains(int v) const
+      {
+        for(int w : variables)
+          if(w == v)
+            return true;
+        return false;
+      }
+    };
+
+    /**
+     * @brief Product of factors summed over one variable
+     *
+     * The result is a dense table over the given variables, the last one
+     * being the inner most. This variable is the vectorized loop, for each
+     * cell of the other variables and each value of the summed variable
+     * the factors are read as strided arrays along it, multiplied and
+     * added up in \ref accumulator<Scalar>. Cells of the other variables
+     * are distributed over the executor.
+     *
+     * @param factors The factors
+     * @param variables The variables of the result, each factor depends
+     * only on these and the summed variable
+     * @param summed The variable summed over, -1 for a plain product
+     * @param extents Extents of all variables of the graph
+     * @param ex Executor
+     */
+    template<typename Scalar, typename Executor>
+    factor<Scalar> factor_product(const std::vector<const factor<Scalar>*>& factors,
+        const std::vector<int>& variables, int summed, const std::vector<int>& extents,
+        const Executor& ex)
+    {
+      typedef typename accumulator<Scalar>::type Acc;
+      typedef Eigen::Array<Acc, Eigen::Dynamic, 1> acc_type;
+      typedef Eigen::Array<Scalar, Eigen::Dynamic, 1> array_type;
+      typedef Eigen::Map<const array_type, 0, Eigen::InnerStride<>> strided_map_type;
+
+      factor<Scalar> result;
+      result.variables = variables;
+      result.posteriors = 0;
+      result.strides.resize(variables.size());
+
+      int size = 1;
+      for(size_t i = variables.size(); i-- > 0;)
+      {
+        result.strides[i] = size;
+        size *= extents[variables[i]];
+      }
+      result.values.resize(size);
+
+      size_t n = factors.size();
+      size_t outer_variables = variables.empty() ? 0 : variables.size() - 1;
+      int inner = variables.empty() ? 1 : extents[variables.back()];
+      int sum_extent = summed < 0 ? 1 : extents[summed];
+
+      // Strides of all factors, the inner most and the summed variable
+      std::vector<int> strides(n * outer_variables), inner_strides(n), sum_strides(n);
+      for(size_t k = 0; k < n; ++k)
+      {
+        for(size_t i = 0; i < outer_variables; ++i)
+          strides[k * outer_variables + i] = factors[k]->stride(variables[i]);
+        inner_strides[k] = variables.empty() ? 0 : factors[k]->stride(variables.back());
+        sum_strides[k] = summed < 0 ? 0 : factors[k]->stride(summed);
+      }
+
+      ex.parallel_for(0, size / inner, [&] (int begin, int end)
+          {
+            acc_type acc(inner), product(inner);
+            std::vector<int> offsets(n);
+
+            for(int o = begin; o < end; ++o)
+            {
+              std::fill(offsets.begin(), offsets.end(), 0);
+              int rest = o;
+              for(size_t i = outer_variables; i-- > 0;)
+              {
+                int index = rest % extents[variables[i]];
+                rest /= extents[variables[i]];
+                for(size_t k = 0; k < n; ++k)
+                  offsets[k] += index * strides[k * outer_variables + i];
+              }
+
+              acc.setConstant(Acc(0));
+              for(int s = 0; s < sum_extent; ++s)
+              {
+                product.setConstant(Acc(1));
+                for(size_t k = 0; k < n; ++k)
+                {
+                  const Scalar* p = factors[k]->values.data() + offsets[k] + s * sum_strides[k];
+                  if(inner_strides[k] == 0)
+                    product *= Acc(*p);
+                  else if(inner_strides[k] == 1)
+                    product *= Eigen::Map<const array_type>(p, inner).template cast<Acc>();
+                  else
+                    product *= strided_map_type(p, inner,
+                        Eigen::InnerStride<>(inner_strides[k])).template cast<Acc>();
+                }
+                acc += product;
+              }
+
+              Eigen::Map<array_type>(result.values.data() + o * inner, inner) =
+                  acc.template cast<Scalar>();
+            }
+          });
+
+      return result;
+    }
+  }
+
+  /**
+   * @brief A set of conditional distributions, e.g. the factors of a
+   * Bayesian network, and the marginals of their product
+   *
+   * Variables are identified by their type, a variable needs to have the
+   * same extent in all distributions. Marginals are computed by variable
+   * elimination:
+   * - factors whose posteriors neither are queried nor appear in any
+   * other factor sum to one and are dropped (repeatedly),
+   * - the remaining variables are eliminated in the order of the min-fill
+   * heuristic, i.e. always the variable whose elimination adds the fewest
+   * edges to the interaction graph of the factors (ties are broken by the
+   * size of the resulting factor),
+   * - each elimination multiplies the factors of the variable and sums it
+   * out in a single pass, see \ref core::factor_product.
+   *
+   * @code
+   * factor_graph<double> network;
+   * network.add(pA);
+   * network.add(pBgA);
+   * network.add(pCgB);
+   * network.add(pDgBC);
+   *
+   * distribution<double, D> pD = network.marginal<D>();
+   * distribution<double, A, D> pAD = network.marginal<A, D>();
+   * @endcode
+   *
+   * The graph keeps copies of the distributions. The factors are assumed
+   * to be conditional distributions (summing to one over their
+   * posteriors), the marginals are the sums of the product of all factors
+   * and are not renormalized.
+   *
+   * @tparam Scalar The scalar type of the distributions
+   */
+  template<typename Scalar>
+  class factor_graph
+  {
+    typedef core::factor<Scalar> factor_type;
+
+    std::vector<const void*> _keys;
+    std::vector<std::string> _labels;
+    std::vector<int> _extents;
+    std::vector<factor_type> _factors;
+
+    int find(const void* key) const
+    {
+      for(size_t i = 0; i < _keys.size(); ++i)
+        if(_keys[i] == key)
+          return i;
+      return -1;
+    }
+
+    template<typename ...V, size_t N>
+    void add_variables(core::vars<V...>, const std::array<int, N>& extents,
+        std::vector<int>& ids)
+    {
+      static_assert(util::traits::are_distinct<V...>::value,
+          "Variables of a factor need to be distinct");
+
+      const void* keys[] = { core::variable_key<V>()... };
+      const std::string labels[] = { V::label()... };
+
+      for(size_t i = 0; i < N; ++i)
+      {
+        int id = find(keys[i]);
+        if(id >= 0 && _extents[id] != extents[i])
+          throw std::invalid_argument("factor_graph: variable " + labels[i] +
+              " has a different extent in another factor");
+      }
+
+      for(size_t i = 0; i < N; ++i)
+      {
+        int id = find(keys[i]);
+        if(id < 0)
+        {
+          id = _keys.size();
+          _keys.push_back(keys[i]);
+          _labels.push_back(labels[i]);
+          _extents.push_back(extents[i]);
+        }
+
+        ids.push_back(id);
+      }
+    }
+
+    template<typename ...T>
+    std::vector<int> targets() const
+    {
+      std::vector<int> ids = { find(core::variable_key<T>())... };
+      const std::string labels[] = { T::label()... };
+      for(size_t i = 0; i < ids.size(); ++i)
+        if(ids[i] < 0)
+          throw std::invalid_argument("factor_graph: variable " + labels[i] +
+              " is not in any factor");
+      return ids;
+    }
+
+    /** @brief The factors the marginal of the targets depends on */
+    std::vector<size_t> relevant(const std::vector<int>& targets) const
+    {
+      std::vector<bool> active(_factors.size(), true);
+
+      bool changed = true;
+      while(changed)
+      {
+        changed = false;
+        for(size_t f = 0; f < _factors.size(); ++f)
+        {
+          if(!active[f])
+            continue;
+
+          bool barren = true;
+          for(size_t i = 0; i < _factors[f].posteriors && barren; ++i)
+          {
+            int v = _factors[f].variables[i];
+            barren = std::find(targets.begin(), targets.end(), v) == targets.end();
+            for(size_t g = 0; g < _factors.size() && barren; ++g)
+              barren = g == f || !active[g] || !_factors[g].contains(v);
+          }
+
+          if(barren)
+          {
+            active[f] = false;
+            changed = true;
+          }
+        }
+      }
+
+      std::vector<size_t> factors;
+      for(size_t f = 0; f < _factors.size(); ++f)
+        if(active[f])
+          factors.push_back(f);
+      return factors;
+    }
+
+    /** @brief Min-fill elimination order of all non target variables */
+    std::vector<int> elimination(const std::vector<size_t>& factors,
+        const std::vector<int>& targets) const
+    {
+      size_t n = _keys.size();
+      std::vector<std::vector<bool>> adjacent(n, std::vector<bool>(n, false));
+      std::vector<bool> present(n, false);
+
+      for(size_t f : factors)
+        for(int v : _factors[f].variables)
+        {
+          present[v] = true;
+          for(int w : _factors[f].variables)
+            adjacent[v][w] = v != w;
+        }
+
+      std::vector<int> candidates;
+      for(size_t v = 0; v < n; ++v)
+        if(present[v] && std::find(targets.begin(), targets.end(), v) == targets.end())
+          candidates.push_back(v);
+
+      std::vector<int> order;
+      while(!candidates.empty())
+      {
+        size_t best = 0;
+        size_t best_fill = 0;
+        double best_weight = 0;
+
+        for(size_t c = 0; c < candidates.size(); ++c)
+        {
+          int v = candidates[c];
+          size_t fill = 0;
+          double weight = _extents[v];
+
+          for(size_t a = 0; a < n; ++a)
+          {
+            if(!present[a] || !adjacent[v][a])
+              continue;
+
+            weight *= _extents[a];
+            for(size_t b = a + 1; b < n; ++b)
+              if(present[b] && adjacent[v][b] && !adjacent[a][b])
+                ++fill;
+          }
+
+          if(c == 0 || fill < best_fill || (fill == best_fill && weight < best_weight))
+          {
+            best = c;
+            best_fill = fill;
+            best_weight = weight;
+          }
+        }
+
+        int v = candidates[best];
+        for(size_t a = 0; a < n; ++a)
+          for(size_t b = 0; b < n; ++b)
+            if(a != b && present[a] && present[b] && adjacent[v][a] && adjacent[v][b])
+              adjacent[a][b] = true;
+
+        present[v] = false;
+        order.push_back(v);
+        candidates.erase(candidates.begin() + best);
+      }
+
+      return order;
+    }
+
+  public:
+    /**
+     * @brief Adds a copy of a distribution @f$ p(a...|b...) @f$ as a factor
+     *
+     * @throws std::invalid_argument if a variable has another extent than
+     * in the factors added before
+     */
+    template<typename ...T>
+    void add(const distribution<Scalar, T...>& d)
+    {
+      typedef distribution<Scalar, T...> dist_type;
+      static constexpr size_t P = dist_type::posterior_type::dim;
+      static constexpr size_t C = dist_type::conditional_type::dim;
+
+      std::array<int, P> col_extents = core::extent_array(d.col_extents());
+      std::array<int, C> row_extents = core::extent_array(d.row_extents());
+
+      std::array<int, P + C> extents;
+      factor_type f;
+      f.posteriors = P;
+
+      for(size_t i = 0; i < P; ++i)
+      {
+        extents[i] = col_extents[i];
+        f.strides.push_back(d.col_strides()[i] * (int)d.colStride());
+      }
+
+      for(size_t i = 0; i < C; ++i)
+      {
+        extents[P + i] = row_extents[i];
+        f.strides.push_back(d.row_strides()[i] * (int)d.rowStride());
+      }
+
+      add_variables(typename util::traits::join<core::vars,
+          typename dist_type::posterior_type,
+          typename dist_type::conditional_type>::type(), extents, f.variables);
+
+      f.values.assign(d.data(), d.data() + d.size());
+      _factors.push_back(std::move(f));
+    }
+
+    /** @brief Number of factors */
+    size_t factors() const
+    {
+      return _factors.size();
+    }
+
+    /** @brief Number of distinct variables of all factors */
+    size_t variables() const
+    {
+      return _keys.size();
+    }
+
+    /**
+     * @brief The labels of the variables in the order they are eliminated
+     * for the marginal of T...
+     *
+     * @throws std::invalid_argument if a variable of T... is in no factor
+     */
+    template<typename ...T>
+    std::vector<std::string> elimination_order() const
+    {
+      std::vector<int> ids = targets<T...>();
+      std::vector<std::string> labels;
+      for(int v : elimination(relevant(ids), ids))
+        labels.push_back(_labels[v]);
+      return labels;
+    }
+
+    /**
+     * @brief The marginal @f$ p(t...) @f$ of the product of all factors
+     *
+     * @tparam T... Variables of the factors
+     * @throws std::invalid_argument if a variable of T... is in no factor
+     * @param ex Executor the products of each elimination are distributed
+     * over
+     */
+    template<typename ...T, typename Executor = serial_executor>
+    distribution<Scalar, T...> marginal(const Executor& ex = Executor()) const
+    {
+      static_assert(core::splitter<T...>::conditionals() == 0,
+          "Marginals are unconditional distributions");
+      static_assert(util::traits::are_distinct<T...>::value,
+          "Variables of a marginal need to be distinct");
+
+      std::vector<int> ids = targets<T...>();
+      std::vector<size_t> needed = relevant(ids);
+
+      std::list<factor_type> active;
+      for(size_t f : needed)
+        active.push_back(_factors[f]);
+
+      for(int v : elimination(needed, ids))
+      {
+        std::vector<const factor_type*> product;
+        std::vector<int> variables;
+
+        for(const factor_type& f : active)
+          if(f.contains(v))
+          {
+            product.push_back(&f);
+            for(int w : f.variables)
+              if(w != v && std::find(variables.begin(), variables.end(), w) == variables.end())
+                variables.push_back(w);
+          }
+
+        factor_type eliminated = core::factor_product(product, variables, v, _extents, ex);
+        active.remove_if([v] (const factor_type& f) { return f.contains(v); });
+        active.push_back(std::move(eliminated));
+      }
+
+      std::vector<const factor_type*> product;
+      for(const factor_type& f : active)
+        product.push_back(&f);
+      factor_type joint = core::factor_product(product, ids, -1, _extents, ex);
+
+      distribution<Scalar, T...> result;
+      result.reshape_dimensions(std::make_tuple(),
+          std::make_tuple(T(_extents[find(core::variable_key<T>())])...));
+      Eigen::Map<Eigen::Array<Scalar, Eigen::Dynamic, 1>>(result.data(), result.size()) =
+          Eigen::Map<const Eigen::Array<Scalar, Eigen::Dynamic, 1>>(joint.values.data(),
+              joint.values.size());
+
+      return result;
+    }
+  };
+}
+
+#endif /* _INFERENCE_H_ */
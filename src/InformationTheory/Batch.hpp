@@ -0,0 +1,203 @@
+#ifndef _IT_BATCH_H_
+#define _IT_BATCH_H_
+
+/**
+ * @file InformationTheory/Batch.hpp
+ *
+ * @brief Information theoretic functions evaluated for a whole
+ * \ref distribution_batch at once
+ */
+
+namespace prob
+{
+  namespace it
+  {
+    /**
+     * @defgroup BATCH Batches
+     * @ingroup IT
+     *
+     * @brief Information theoretic functions of many distributions
+     *
+     * Each function returns one value per member of the batch. The loops run
+     * over the cells and process the values of all members of a chunk
+     * as one vector. The members are split into chunks over the executor.
+     *
+     * @{
+     */
+
+    /**
+     * @brief Information theoretic functions of distribution batches
+     */
+    namespace batch
+    {
+      /**
+       * @brief Entropies of all members of a batch
+       *
+       * @param b Batch of distributions @f$ p_k(x...) @f$
+       * @param ex Executor the members are distributed over
+       * @return @f$ H_k(X) @f$ in bits for each member k
+       */
+      template<typename Log = precise_log, typename Scalar, typename ...T,
+      typename Executor = serial_executor>
+      typename distribution_batch<Scalar, T...>::result_type
+      entropy(const distribution_batch<Scalar, T...>& b,
+          const Executor& ex = Executor())
+      {
+        static_assert(!distribution<Scalar, T...>::conditional_distribution(),
+            "Cannot calculate entropy of a conditional distribution");
+
+        typedef typename distribution_batch<Scalar, T...>::result_type result_type;
+        result_type result(b.size());
+
+        ex.parallel_for(0, b.size(), [&] (int begin, int end)
+            {
+              int n = end - begin;
+              result_type acc = result_type::Zero(n);
+
+              for(int c = 0; c < b.cells(); ++c)
+              {
+                auto p = b.values(c).segment(begin, n).array();
+                Log::weighted_log_accumulate(p, p, acc);
+              }
+
+              result.segment(begin, n) = -acc / log_of_2<Scalar>();
+            });
+
+        return result;
+      }
+
+      /**
+       * @brief Conditional entropies of all members of two batches
+       *
+       * @param bAgB Batch of conditional distributions @f$ p_k(a...|b...) @f$
+       * @param bB Batch of marginal distributions @f$ p_k(b...) @f$
+       * @param ex Executor the members are distributed over
+       * @return @f$ H_k(A|B) @f$ in bits for each member k
+       */
+      template<typename Log = precise_log, typename BatchAgB, typename BatchB,
+      typename Executor = serial_executor>
+      typename BatchAgB::result_type
+      conditional_entropy(const BatchAgB& bAgB, const BatchB& bB,
+          const Executor& ex = Executor())
+      {
+        typedef typename BatchAgB::scalar Scalar;
+        typedef typename BatchAgB::result_type result_type;
+
+        assert(bAgB.size() == bB.size() && bAgB.rows() == bB.cells());
+        result_type result(bAgB.size());
+
+        ex.parallel_for(0, bAgB.size(), [&] (int begin, int end)
+            {
+              int n = end - begin;
+              result_type acc = result_type::Zero(n);
+
+              for(int a = 0; a < bAgB.cols(); ++a)
+                for(int r = 0; r < bAgB.rows(); ++r)
+                {
+                  auto p = bAgB.values(bAgB.cell(r, a)).segment(begin, n).array();
+                  auto pB = bB.values(r).segment(begin, n).array();
+                  Log::weighted_log_accumulate(p * pB, p, acc);
+                }
+
+              result.segment(begin, n) = -acc / log_of_2<Scalar>();
+            });
+
+        return result;
+      }
+
+      /**
+       * @brief Mutual informations of all members of two batches
+       *
+       * The marginals @f$ p_k(a...) @f$ are derived on the fly, one
+       * posterior cell at a time.
+       *
+       * @param bAgB Batch of conditional distributions @f$ p_k(a...|b...) @f$
+       * @param bB Batch of marginal distributions @f$ p_k(b...) @f$
+       * @param ex Executor the members are distributed over
+       * @return @f$ I_k(A;B) @f$ in bits for each member k
+       */
+      template<typename Log = precise_log, typename BatchAgB, typename BatchB,
+      typename Executor = serial_executor>
+      typename BatchAgB::result_type
+      mutual_information(const BatchAgB& bAgB, const BatchB& bB,
+          const Executor& ex = Executor())
+      {
+        typedef typename BatchAgB::scalar Scalar;
+        typedef typename BatchAgB::result_type result_type;
+
+        assert(bAgB.size() == bB.size() && bAgB.rows() == bB.cells());
+        result_type result(bAgB.size());
+
+        ex.parallel_for(0, bAgB.size(), [&] (int begin, int end)
+            {
+              int n = end - begin;
+              result_type acc = result_type::Zero(n);
+              result_type pA(n);
+
+              for(int a = 0; a < bAgB.cols(); ++a)
+              {
+                pA.setZero();
+                for(int r = 0; r < bAgB.rows(); ++r)
+                  pA += bAgB.values(bAgB.cell(r, a)).segment(begin, n).array() *
+                      bB.values(r).segment(begin, n).array();
+
+                for(int r = 0; r < bAgB.rows(); ++r)
+                {
+                  auto p = bAgB.values(bAgB.cell(r, a)).segment(begin, n).array();
+                  auto pB = bB.values(r).segment(begin, n).array();
+                  Log::weighted_log_accumulate(p * pB, p / pA, acc);
+                }
+              }
+
+              result.segment(begin, n) = acc / log_of_2<Scalar>();
+            });
+
+        return result;
+      }
+
+      /**
+       * @brief Kullback-Leibler divergences between the members of two
+       * batches
+       *
+       * @param bP Batch of distributions @f$ p_k(x...) @f$
+       * @param bQ Batch of distributions @f$ q_k(x...) @f$
+       * @param ex Executor the members are distributed over
+       * @return @f$ \operatorname{Div}_{KL}(p_k(\cdot) || q_k(\cdot)) @f$ in bits
+       * for each member k
+       */
+      template<typename Log = precise_log, typename Batch,
+      typename Executor = serial_executor>
+      typename Batch::result_type
+      kl_divergence(const Batch& bP, const Batch& bQ,
+          const Executor& ex = Executor())
+      {
+        typedef typename Batch::scalar Scalar;
+        typedef typename Batch::result_type result_type;
+
+        assert(bP.size() == bQ.size() && bP.cells() == bQ.cells());
+        result_type result(bP.size());
+
+        ex.parallel_for(0, bP.size(), [&] (int begin, int end)
+            {
+              int n = end - begin;
+              result_type acc = result_type::Zero(n);
+
+              for(int c = 0; c < bP.cells(); ++c)
+              {
+                auto p = bP.values(c).segment(begin, n).array();
+                auto q = bQ.values(c).segment(begin, n).array();
+                Log::weighted_log_accumulate(p, p / q, acc);
+              }
+
+              result.segment(begin, n) = acc / log_of_2<Scalar>();
+            });
+
+        return result;
+      }
+    }
+
+    /** @} */
+  }
+}
+
+#endif /* _IT_BATCH_H_ */
@@ -4,6 +4,7 @@
 #ifdef PROB_EXPERIMENTAL
 
 #define PROB_NL_PRECISION 1e-5
+#define PROB_NL_ITERATIONS 100000
 
 #ifdef PROB_REDUNDANT_INFORMATION
 #include <nlopt.hpp>
@@ -57,266 +58,221 @@ namespace prob
 
           return sum - 1;
         }
+#endif
 
-        double sum_one(const std::vector<double> &x, std::vector<double> &grad,
-            void *data)
+        /**
+         * @brief Intermediate distributions of the icm objective
+         *
+         * All distributions are shaped once by the constructor, every
+         * evaluation of the objective writes into them in place.
+         */
+        template<typename DistXYgZ, typename DistZ, typename DistZgZ,
+            typename DistXgZ, typename DistYgZ, size_t sX, size_t sY>
+        struct icm_workspace
         {
+          typedef typename DistZ::scalar Scalar;
+          typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> matrix;
 
-          if (!grad.empty())
-          {
-            for (unsigned i = 0; i < x.size(); i++)
-              grad[i] = 1;
-          }
-          double sum = 0;
-          for (unsigned i = 0; i < x.size(); i++)
-            sum += x[i];
-
-          return sum - 1;
-        }
-
-        template<typename DistZ>
-        double red_objective(const std::vector<double> &x,
-            std::vector<double> &grad, void *data)
-        {
-          unsigned dim = x.size();
-          std::tuple<DistZ const * const, std::vector<DistZ> const * const >* data_tuple =
-              reinterpret_cast<std::tuple<DistZ const * const,
-                  std::vector<DistZ> const * const >*>(data);
+          /** @brief p(z)p(x,y|z), constant during the optimization */
+          matrix weighted;
 
-          DistZ q(std::get<1> (*data_tuple)->front());
-          q.setZero();
+          DistZgZ dZngZ;
+          DistZ dZn;
+          DistXYgZ dXYgZn;
+          DistXgZ dXgZn;
+          DistYgZ dYgZn;
 
-          double sum = 1;
-          for (unsigned i = 0; i < dim; i++)
+          icm_workspace(const DistXYgZ& dXYgZ, const DistZ& dZ) :
+            weighted(dXYgZ)
           {
-            q += x[i] * (*std::get<1> (*data_tuple))[i];
-            sum -= x[i];
+            weighted.array().colwise() *= dZ.transpose().array();
+
+            dZngZ.reshape_dimensions(dZ.col_extents(), dZ.col_extents());
+            dZn.reshape_dimensions(dZ.row_extents(), dZ.col_extents());
+            dXYgZn.reshape_dimensions(dXYgZ.row_extents(), dXYgZ.col_extents());
+            dXgZn.reshape_dimensions(dXYgZ.row_extents(),
+                util::tuple::subset(dXYgZ.col_extents(),
+                    typename util::compile_time_list::iota_0<sX>::type()));
+            dYgZn.reshape_dimensions(dXYgZ.row_extents(),
+                util::tuple::subset(dXYgZ.col_extents(),
+                    typename util::compile_time_list::iota_n<sX, sX + sY>::type()));
           }
-          q += sum * (*std::get<1> (*data_tuple))[dim];
-
-          return it::kl_divergence((*std::get<0> (*data_tuple)), q);
-
-        }
-
-        template<typename DistXYgZ, typename DistZ, typename DistZgZ,
-            typename DistXgZ, typename DistYgZ, size_t sX, size_t sY, size_t sZ>
-        double icm_objective(const std::vector<double> &x,
-            std::vector<double> &grad, void *data)
-        {
-          typedef std::tuple<DistXYgZ const * const, DistZ const * const > data_type;
-
-          data_type * data_tuple = reinterpret_cast<data_type*>(data);
-
-          DistXYgZ const * const dXYgZ = std::get<0> (*data_tuple);
-          DistZ const * const dZ = std::get<1> (*data_tuple);
-
-          DistZgZ dZngZ = square(*dZ);
 
-          unsigned dimZ = dZ->cols();
-
-          unsigned i = 0;
-
-          for (unsigned r = 0; r < dimZ; r++)
-            for (unsigned c = 0; c < dimZ; c++)
-              dZngZ.coeffRef(r, c) = x[i++];
-
-          std::cout << dZngZ << std::endl;
-
-          auto dXYZngZ = join_conditionals(*dXYgZ, dZngZ);
-
-          typedef typename util::compile_time_list::iota_0<sX + sY + sZ>::type index_typeXYZ;
-          auto dXYZn = marginalize(uncondition(dXYZngZ, *dZ), index_typeXYZ());
-          typedef typename util::compile_time_list::iota_n<sX + sY, sX + sY + sZ>::type index_typeZ;
-          DistZ dZn = marginalize(dXYZn, index_typeZ());
+          /** @brief I(X;Y|Z') for the channel p(z'|z) given row by row in x */
+          double objective(const std::vector<double> &x)
+          {
+            int dimZ = dZn.cols();
 
-          typedef typename util::compile_time_list::iota_n<sX, sX + sY + sZ>::type index_typeYZ;
-          auto dYZn = marginalize(dXYZn, index_typeYZ());
+            unsigned i = 0;
+            for (int r = 0; r < dimZ; r++)
+              for (int c = 0; c < dimZ; c++)
+                dZngZ.coeffRef(r, c) = x[i++];
 
-          typedef typename util::compile_time_list::join_lists<
-              typename util::compile_time_list::iota_0<sX>::type, index_typeZ>::type index_typeXZ;
-          auto dXZn = marginalize(dXYZn, index_typeXZ());
+            // p(x,y,z') = sum_z p(z'|z)p(z)p(x,y|z) with z' in the rows,
+            // the coefficient based product needs no temporaries
+            dXYgZn.noalias() = dZngZ.transpose().lazyProduct(weighted);
+            dZn.noalias() = dXYgZn.rowwise().sum().transpose();
 
-          DistXYgZ dXYgZn;
-          condition(dXYZn, dZn, dXYgZn);
+            for (int z = 0; z < dimZ; z++)
+              dXYgZn.row(z) *= dZn.coeff(z) == 0 ? Scalar(0) : Scalar(1) / dZn.coeff(z);
 
-          DistXgZ dXgZn;
-          condition(dXZn, dZn, dXgZn);
+            // Column x*|Y|+y of p(x,y|z') belongs to the columns x and y
+            // of p(x|z') and p(y|z')
+            int colsY = dYgZn.cols();
 
-          DistYgZ dYgZn;
-          condition(dYZn, dZn, dYgZn);
-
-          std::cout << dXYgZn << std::endl;
-
-          double cmi = conditional_mutual_information(dXYgZn, dXgZn, dYgZn,
-              dZn);
+            dXgZn.setZero();
+            dYgZn.setZero();
+            for (int xy = 0; xy < dXYgZn.cols(); xy++)
+            {
+              dXgZn.col(xy / colsY) += dXYgZn.col(xy);
+              dYgZn.col(xy % colsY) += dXYgZn.col(xy);
+            }
 
-          std::cout << cmi << std::endl;
+            return conditional_mutual_information(dXYgZn, dXgZn, dYgZn, dZn);
+          }
+        };
 
-          return cmi;
+        template<typename Workspace>
+        double icm_objective(const std::vector<double> &x,
+            std::vector<double> &grad, void *data)
+        {
+          return reinterpret_cast<Workspace*>(data)->objective(x);
         }
 
         /** @cond PRIVATE */
-        template<typename ...T>
-        struct redundancy_impl;
-
+#ifdef PROB_REDUNDANT_INFORMATION
         template<typename ...T>
         struct icm_information_impl;
 #endif
 
+        template<typename ...T>
+        struct redundancy_impl;
+
         template<typename ...T>
         struct minimal_information_impl;
         /** @endcond */
 
-#ifdef PROB_REDUNDANT_INFORMATION
         template<template<typename ...> class V,
         typename ... X,
         typename ... Y,
         typename ... Z,
-        typename Scalar>
-        struct redundancy_impl<Scalar, V<X...>, V<Y...>, V<Z...>>
+        typename Scalar,
+        typename Executor>
+        struct redundancy_impl<Scalar, V<X...>, V<Y...>, V<Z...>, Executor>
         {
           typedef distribution<Scalar, Z..., given, X...> DistZgX;
           typedef distribution<Scalar, Z..., given, Y...> DistZgY;
-          typedef distribution<Scalar, Z..., Y...> DistZY;
 
           typedef distribution<Scalar, X...> DistX;
           typedef distribution<Scalar, Y...> DistY;
           typedef distribution<Scalar, Z...> DistZ;
 
-          typedef Eigen::Matrix<double, Eigen::Dynamic, 1> row_vector;
-
-          static std::vector<DistZ> project(
-              const std::vector<DistZ>& source,
-              const std::vector<DistZ>& target
-          )
+          typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> matrix;
+          typedef Eigen::Matrix<Scalar, Eigen::Dynamic, 1> column;
+          typedef Eigen::Matrix<Scalar, 1, Eigen::Dynamic> row;
+
+          /**
+           * Projects every row of source onto the convex hull of the rows of
+           * target, i.e. row s of the result is the mixture
+           * @f$ q = \sum_i w_i t_i @f$ minimizing @f$ D(p_s || q) @f$.
+           * The weights follow the exponentiated gradient step
+           * @f$ w_i \leftarrow w_i g_i @f$ with the negative gradient
+           * @f$ g_i = \sum_z t_i(z) p(z) / q(z) @f$, which stays on the
+           * simplex since @f$ \sum_i w_i g_i = 1 @f$. The objective is at most
+           * @f$ \log \max_i g_i @f$ above its minimum, which ends the iteration.
+           */
+          template<typename Source, typename Target>
+          static matrix project(const Source& source, const Target& target,
+              const Executor& ex)
           {
-            std::vector<DistZ> projected;
-
-            unsigned dim = target.size() - 1;
-            std::vector<double> lb(dim,0);
-            std::vector<double> ub(dim,1);
+            matrix projected(source.rows(), source.cols());
 
-            nlopt::opt opt(nlopt::LN_COBYLA, dim);
+            int dim = target.rows();
 
-            opt.set_lower_bounds(lb);
-            opt.set_upper_bounds(ub);
+            ex.parallel_for(0, source.rows(), [&] (int begin, int end)
+                {
+                  // Workspaces are shared by all rows of the chunk
+                  column w(dim), g(dim);
+                  row q(source.cols()), r(source.cols());
 
-            opt.add_inequality_constraint(sum_one, nullptr, PROB_NL_PRECISION);
-            opt.set_xtol_rel(PROB_NL_PRECISION);
+                  for(int s = begin; s < end; ++s)
+                  {
+                    w.setConstant(Scalar(1) / dim);
 
-            for(const DistZ& p : source)
-            {
-              std::tuple<DistZ const * const, std::vector<DistZ> const * const>
-              data = std::make_tuple(&p, &target);
+                    for(int it = 0; it < PROB_NL_ITERATIONS; ++it)
+                    {
+                      q.noalias() = w.transpose() * target;
 
-              opt.set_min_objective(red_objective<DistZ>, (void*)&data);
+                      // Mass of p where no target puts any is lost anyway
+                      for(int z = 0; z < q.cols(); ++z)
+                        r(z) = q(z) > 0 ? Scalar(source.coeff(s, z) / q(z)) : Scalar(0);
 
-              std::vector<double> x(dim, 0.5);
-              double minf;
-              opt.optimize(x, minf);
+                      g.noalias() = target * r.transpose();
 
-              DistZ q(p);
-              q.setZero();
+                      if(log(g.maxCoeff()) < PROB_NL_PRECISION)
+                        break;
 
-              double sum=1;
-              for(unsigned i=0;i<dim;i++)
-              {
-                q += x[i] * target[i];
-                sum -= x[i];
-              }
-              q += sum * target[dim];
+                      w.array() *= g.array();
+                      w /= w.sum();
+                    }
 
-              projected.push_back(q);
-            }
+                    projected.row(s).noalias() = w.transpose() * target;
+                  }
+                });
 
             return projected;
           }
 
-          static Scalar redundancy(
-              const DistZgX& dZgX,
-              const DistZgY& dZgY,
-              const DistX& dX,
-              const DistY& dY,
-              const DistZ& dZ)
+          template<typename DistZgA, typename DistA>
+          static Scalar projected_information(
+              const DistZgA& dZgA,
+              const DistA& dA,
+              const DistZ& dZ,
+              const matrix& projected,
+              const Executor& ex)
           {
-            std::vector<DistZ> vdZgX;
-            std::vector<DistZ> vdZgY;
-
-            std::vector<DistZ> projected_vdZgX;
-            std::vector<DistZ> projected_vdZgY;
-
-            // Extract the conditional distributions
-            dZgX.each_conditional_index(
-                [&vdZgX, &dZgX] (const X&... x)
-                {
-                  vdZgX.push_back(dZgX.posterior_distribution(x...));
-                });
-
-            dZgY.each_conditional_index(
-                [&vdZgY, &dZgY] (const Y&... y)
+            // Row a of p(z|a) is read in place and belongs to row a of projected
+            return prob::core::parallel_sum<Scalar>(ex, 0, dZgA.rows(),
+                [&] (int begin, int end)
                 {
-                  vdZgY.push_back(dZgY.posterior_distribution(y...));
-                });
-
-            projected_vdZgX = project(vdZgX, vdZgY);
-            projected_vdZgY = project(vdZgY, vdZgX);
-
-            Scalar red_x(0), red_y(0);
-            typename std::vector<DistZ>::iterator pX = projected_vdZgX.begin();
-            typename std::vector<DistZ>::iterator pY = projected_vdZgY.begin();
-
-            dZgX.each_conditional_index(
-                [&pX, &dZgX, &dX, &dZ, &red_x] (const X&... x)
-                {
-                  if(dX(x...) <= 1e-18)
+                  Scalar s(0);
+                  for(int a = begin; a < end; ++a)
                   {
-                    pX++;
-                    return;
-                  }
+                    if(dA.coeff(a) <= 1e-18)
+                      continue;
 
-                  DistZ dZgx = dZgX.posterior_distribution(x...);
-                  Scalar dx = dX(x...);
+                    Scalar info(0);
+                    for(int z = 0; z < dZgA.cols(); ++z)
+                      if(dZgA.coeff(a, z) >= 1e-18)
+                        info += dZgA.coeff(a, z) *
+                          log2_fraction(projected.coeff(a, z), dZ.coeff(z));
 
-                  dZ.each_index(
-                      [&pX, &dZgx, &dx, &dZ, &red_x] (const Z&... z)
-                      {
-                        if(dZgx(z...) >= 1e-18)
-                        red_x += dZgx(z...) * dx *
-                        log2_fraction((*pX)(z...),dZ(z...));
-                      }
-                  );
-
-                  pX++;
-                });
-
-            dZgY.each_conditional_index(
-                [&pY, &dZgY, &dY, &dZ, &red_y] (const Y&... y)
-                {
-                  if(dY(y...) <= 1e-18)
-                  {
-                    pY++;
-                    return;
+                    s += dA.coeff(a) * info;
                   }
-
-                  DistZ dZgy = dZgY.posterior_distribution(y...);
-                  Scalar dy = dY(y...);
-
-                  dZ.each_index(
-                      [&pY, &dZgy, &dy, &dZ, &red_y] (const Z&... z)
-                      {
-                        if(dZgy(z...) >= 1e-18)
-                        red_y += dZgy(z...) * dy *
-                        log2_fraction((*pY)(z...),dZ(z...));
-                      }
-                  );
-
-                  pY++;
+                  return s;
                 });
+          }
+
+          static Scalar redundancy(
+              const DistZgX& dZgX,
+              const DistZgY& dZgY,
+              const DistX& dX,
+              const DistY& dY,
+              const DistZ& dZ,
+              const Executor& ex)
+          {
+            // The posteriors p(z|x) and p(z|y) are the rows of the
+            // conditional distributions, both are projected in place
+            Scalar red_x = projected_information(dZgX, dX, dZ,
+                project(dZgX, dZgY, ex), ex);
+            Scalar red_y = projected_information(dZgY, dY, dZ,
+                project(dZgY, dZgX, ex), ex);
 
             return std::min(red_y, red_x);
           }
         };
 
+#ifdef PROB_REDUNDANT_INFORMATION
         template<template<typename ...> class V,
         typename ... X,
         typename ... Y,
@@ -357,21 +313,15 @@ namespace prob
 
           opt.set_xtol_rel(PROB_NL_PRECISION);
 
-          std::tuple<DistXYgZ const * const,
-          DistZ const * const> data =
-          std::make_tuple(&dXYgZ, &dZ);
-
-          opt.set_min_objective(icm_objective<
-              DistXYgZ,
-              DistZ,
-              DistZgZ,
-              DistXgZ,
-              DistYgZ,
-              sizeof...(X),
-              sizeof...(Y),
-              sizeof...(Z)>, (void*)&data);
-
-          std::vector<double> x(dimZgZ, 1/dimZ);
+          typedef icm_workspace<DistXYgZ, DistZ, DistZgZ, DistXgZ, DistYgZ,
+              sizeof...(X), sizeof...(Y)> workspace_type;
+
+          workspace_type workspace(dXYgZ, dZ);
+
+          opt.set_min_objective(icm_objective<workspace_type>,
+              (void*)&workspace);
+
+          std::vector<double> x(dimZgZ, 1.0 / dimZ);
           double minf;
           opt.optimize(x, minf);
 
@@ -396,52 +346,47 @@ namespace prob
         typedef distribution<Scalar, Y...> DistY;
         typedef distribution<Scalar, Z...> DistZ;
 
+        template<typename Executor>
         static Scalar minimal_information(
             const DistXgZ& dXgZ,
             const DistYgZ& dYgZ,
-            const DistZ& dZ)
+            const DistZ& dZ,
+            const Executor& ex)
         {
-          Scalar min_info(0);
-
           typedef typename util::compile_time_list::iota_0<sizeof...(X)>::type index_typeX;
-        DistX dX(marginalize(uncondition(dXgZ,dZ), index_typeX()));
-
-        typedef typename util::compile_time_list::iota_0<sizeof...(Y)>::type index_typeY;
-        DistY dY(marginalize(uncondition(dYgZ,dZ), index_typeY()));
-
-        dZ.each_index([&] (const Z&... z)
-            {
-              Scalar x_info(0);
-              Scalar y_info(0);
-
-              DistX dXgz = dXgZ.posterior_distribution(z...);
-              DistY dYgz = dYgZ.posterior_distribution(z...);
-
-              dX.each_index([&] (const X&... x)
-                  {
-                    x_info += xlogy( dXgz(x...), dXgz(x...) / dX(x...));
-                  });
+          DistX dX(marginalize(lazy::uncondition(dXgZ, dZ), index_typeX()));
 
-              x_info /= log_of_2<Scalar>();
+          typedef typename util::compile_time_list::iota_0<sizeof...(Y)>::type index_typeY;
+          DistY dY(marginalize(lazy::uncondition(dYgZ, dZ), index_typeY()));
 
-              dY.each_index([&] (const Y&... y)
-                  {
-                    y_info += xlogy( dYgz(y...), dYgz(y...) / dY(y...));
-                  });
+          // Row z of p(x|z) and p(y|z) belongs to column z of p(z), the
+          // specific information of each event is read in place
+          Scalar min_info = prob::core::parallel_sum<Scalar>(ex, 0, dZ.cols(),
+              [&] (int begin, int end)
+              {
+                Scalar s(0);
+                for(int z = begin; z < end; ++z)
+                {
+                  Scalar x_info(0);
+                  for(int x = 0; x < dXgZ.cols(); ++x)
+                    x_info += xlogxovery(dXgZ.coeff(z, x), dX.coeff(x));
 
-              y_info /= log_of_2<Scalar>();
+                  Scalar y_info(0);
+                  for(int y = 0; y < dYgZ.cols(); ++y)
+                    y_info += xlogxovery(dYgZ.coeff(z, y), dY.coeff(y));
 
-              min_info += dZ(z...) * std::min(x_info, y_info);
-            });
+                  s += dZ.coeff(z) * std::min(x_info, y_info);
+                }
+                return s;
+              });
 
-        return min_info;
-      }
+          return min_info / log_of_2<Scalar>();
+        }
 
     };
 
         }
 
-#ifdef PROB_REDUNDANT_INFORMATION
       /**
        * Calculate the redundant information defined as
        * @f[ I_{ \operatorname{red}}(Z;X,Y) = \min \{ I^\pi_Z(X \searrow Y), I^\pi_Z(Y \searrow X) \}  @f]
@@ -449,26 +394,30 @@ namespace prob
        * This value can be used to decompose the mutual information @f$I(Z;X,Y)@f$ by
        * using the redundant information as the redundancy term in the decomposition
        * of Williams and Beer. See the linked article for a detailed account.
+       * The projections are found by an exponentiated gradient descent on
+       * the mixture weights and do not require NLopt.
        *
        * @param dZgX @f$p(z|x)@f$
        * @param dZgY @f$p(z|y)@f$
        * @param dX @f$p(x)@f$
        * @param dY @f$p(y)@f$
        * @param dZ @f$p(z)@f$
+       * @param ex Executor the projections and sums are distributed over
        * @return @f$ I_{ \operatorname{red}}(Z;X,Y) @f$ as a Scalar
        */
         template<typename DistZgX, typename DistZgY, typename DistX,
-        typename DistY, typename DistZ>
+        typename DistY, typename DistZ, typename Executor = serial_executor>
         typename DistZgX::scalar redundancy(const DistZgX& dZgX,
             const DistZgY& dZgY, const DistX& dX, const DistY& dY,
-            const DistZ& dZ)
+            const DistZ& dZ, const Executor& ex = Executor())
         {
           return core::redundancy_impl<typename DistZ::scalar,
           typename DistX::posterior_type, typename DistY::posterior_type,
-          typename DistZgY::posterior_type>::redundancy(dZgX, dZgY, dX, dY,
-              dZ);
+          typename DistZgY::posterior_type, Executor>::redundancy(dZgX, dZgY,
+              dX, dY, dZ, ex);
         }
 
+#ifdef PROB_REDUNDANT_INFORMATION
         /** Calculate the intrinsic conditional mutual information defined as
          *  @f[ I_{ \operatorname{icm}}(Z;X,Y) = \min_{p(z'|z)} I(X;Y|Z')  @f]
          *  with @f$|Z'|=|Z|@f$ by
@@ -504,15 +453,18 @@ namespace prob
        * @param dXgZ @f$p(x|z)@f$
        * @param dYgZ @f$p(y|z)@f$
        * @param dZ @f$p(z)@f$
+       * @param ex Executor the events of Z are distributed over
        * @return @f$I_\min(Z;\{X,Y\})@f$ as a Scalar
        */
-      template<typename DistXgZ, typename DistYgZ, typename DistZ>
+      template<typename DistXgZ, typename DistYgZ, typename DistZ,
+      typename Executor = serial_executor>
       typename DistZ::scalar minimal_information(const DistXgZ& dXgZ,
-          const DistYgZ& dYgZ, const DistZ& dZ)
+          const DistYgZ& dYgZ, const DistZ& dZ, const Executor& ex = Executor())
       {
         return core::minimal_information_impl<typename DistZ::scalar,
             typename DistXgZ::posterior_type, typename DistYgZ::posterior_type,
-            typename DistZ::posterior_type>::minimal_information(dXgZ, dYgZ, dZ);
+            typename DistZ::posterior_type>::minimal_information(dXgZ, dYgZ,
+                dZ, ex);
       }
 
     }
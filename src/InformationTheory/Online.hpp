@@ -0,0 +1,215 @@
+#ifndef _IT_ONLINE_H_
+#define _IT_ONLINE_H_
+
+/**
+ * @file InformationTheory/Online.hpp
+ *
+ * @brief Entropies and mutual information of sample streams, updated per sample
+ */
+
+namespace prob
+{
+  namespace it
+  {
+    /**
+     * @addtogroup IT
+     * @{
+     */
+
+    /**
+     * @brief Information measures of the empirical distribution of a
+     * stream of samples, updated incrementally
+     *
+     * Keeps the counts n(a, b) of the samples of the random variables
+     * T... = A..., given, B... together with the marginal counts n(a) and
+     * n(b) and for each of the three tables the sum
+     * @f$ S = \sum n \log n @f$. The entropy of a table of N samples is
+     * @f$ \log N - S / N @f$, hence adding or removing a sample changes
+     * three cells and three sums and all measures are available in
+     * constant time. Removing samples allows sliding windows over a stream:
+     *
+     * @code
+     * it::online_information<X, given, Y> window(X(8) | Y(4));
+     * for(...)
+     * {
+     *   window.add(sample);
+     *   if(n > window_size)
+     *     window.remove(old_sample);
+     *   double mi = window.mutual_information();
+     * }
+     * @endcode
+     *
+     * Samples are the indices of all posterior and then all conditional
+     * variables, as in \ref counts. The sums accumulate rounding errors over
+     * very long streams, recompute() sets them from the counts again.
+     */
+    template<typename ...T>
+    class online_information
+    {
+    public:
+      typedef distribution<double, T...> distribution_type;
+
+    private:
+      static constexpr size_t P = prob::core::splitter<T...>::posteriors();
+      static constexpr size_t C = prob::core::splitter<T...>::conditionals();
+
+      /** @brief Joint counts, rows are the conditional events */
+      distribution_type _joint;
+      /** @brief Counts of the posterior events a... */
+      Eigen::ArrayXd _posterior;
+      /** @brief Counts of the conditional events b... */
+      Eigen::ArrayXd _conditional;
+
+      double _total = 0;
+      double _joint_sum = 0;
+      double _posterior_sum = 0;
+      double _conditional_sum = 0;
+
+      std::array<int, P + C> _extents;
+
+      static double nlogn(double n)
+      {
+        return n > 0 ? n * std::log(n) : 0;
+      }
+
+      /** @brief Entropy in bits of a table of _total samples with sum S */
+      double entropy_of(double sum) const
+      {
+        if(_total <= 0)
+          return 0;
+        return (std::log(_total) - sum / _total) / log_of_2<double>();
+      }
+
+      /** @brief Add a weight to a count and the corresponding sum */
+      static void update(double& count, double& sum, double weight)
+      {
+        sum -= nlogn(count);
+        count += weight;
+        sum += nlogn(count);
+      }
+
+      void init()
+      {
+        _joint.setZero();
+        _posterior.setZero(_joint.cols());
+        _conditional.setZero(_joint.rows());
+
+        std::array<int, P> col_extents = prob::core::extent_array(_joint.col_extents());
+        std::array<int, C> row_extents = prob::core::extent_array(_joint.row_extents());
+        std::copy(col_extents.begin(), col_extents.end(), _extents.begin());
+        std::copy(row_extents.begin(), row_extents.end(), _extents.begin() + P);
+      }
+
+    public:
+      /** @brief Constructor for statically sized random variables */
+      online_information()
+      {
+        init();
+      }
+
+      /**
+       * @brief Constructor for dynamically sized random variables, takes the
+       * extents as \ref distribution does
+       */
+      template<typename... _T>
+      online_information(_T... t) :
+          _joint(t...)
+      {
+        init();
+      }
+
+      /**
+       * @brief Add a sample with the given weight, a negative weight
+       * removes samples
+       */
+      void add(const int* sample, double weight = 1)
+      {
+        int col = 0, row = 0;
+        for(size_t i = 0; i < P; ++i)
+        {
+          assert(sample[i] >= 0 && sample[i] < _extents[i]);
+          col += sample[i] * _joint.col_strides()[i];
+        }
+        for(size_t i = 0; i < C; ++i)
+        {
+          assert(sample[P + i] >= 0 && sample[P + i] < _extents[P + i]);
+          row += sample[P + i] * _joint.row_strides()[i];
+        }
+
+        update(_joint.coeffRef(row, col), _joint_sum, weight);
+        update(_posterior(col), _posterior_sum, weight);
+        update(_conditional(row), _conditional_sum, weight);
+        _total += weight;
+      }
+
+      /** @brief Remove a previously added sample */
+      void remove(const int* sample)
+      {
+        add(sample, -1);
+      }
+
+      /** @brief Add n samples stored row major as in \ref counts::add_samples */
+      void add_samples(const int* samples, size_t n)
+      {
+        for(size_t k = 0; k < n; ++k)
+          add(samples + k * (P + C));
+      }
+
+      /** @brief Recalculate the sums from the counts */
+      void recompute()
+      {
+        auto f = [] (double n) { return nlogn(n); };
+        _total = _posterior.sum();
+        _joint_sum = _joint.unaryExpr(f).sum();
+        _posterior_sum = _posterior.unaryExpr(f).sum();
+        _conditional_sum = _conditional.unaryExpr(f).sum();
+      }
+
+      /** @brief Number of samples (sum of all weights) */
+      double total() const
+      {
+        return _total;
+      }
+
+      /** @brief The joint counts n(a..., b...) as conditional table */
+      const distribution_type& values() const
+      {
+        return _joint;
+      }
+
+      /** @brief @f$ H(A,B) @f$ in bits */
+      double joint_entropy() const
+      {
+        return entropy_of(_joint_sum);
+      }
+
+      /** @brief @f$ H(A) @f$ in bits */
+      double posterior_entropy() const
+      {
+        return entropy_of(_posterior_sum);
+      }
+
+      /** @brief @f$ H(B) @f$ in bits */
+      double conditional_marginal_entropy() const
+      {
+        return entropy_of(_conditional_sum);
+      }
+
+      /** @brief @f$ H(A|B) = H(A,B) - H(B) @f$ in bits */
+      double conditional_entropy() const
+      {
+        return joint_entropy() - conditional_marginal_entropy();
+      }
+
+      /** @brief @f$ I(A;B) = H(A) + H(B) - H(A,B) @f$ in bits */
+      double mutual_information() const
+      {
+        return posterior_entropy() + conditional_marginal_entropy() - joint_entropy();
+      }
+    };
+
+    /** @} */
+  }
+}
+
+#endif /* _IT_ONLINE_H_ */
@@ -0,0 +1,130 @@
+#ifndef _IT_SPARSE_H_
+#define _IT_SPARSE_H_
+
+/**
+ * @file InformationTheory/Sparse.hpp
+ *
+ * @brief Information theoretic functions of \ref sparse_distribution
+ */
+
+namespace prob
+{
+  namespace it
+  {
+    namespace core
+    {
+      /**
+       * @brief Collects pairs (w, v) and sums w*log(v) blockwise with the
+       * logarithm policy Log
+       *
+       * The stored probabilities of a sparse distribution are not contiguous,
+       * the buffer hands them to the (vectorized) policies in blocks.
+       */
+      template<typename Log, typename Scalar>
+      class weighted_log_buffer
+      {
+        typedef typename prob::core::real_scalar<Scalar>::type Real;
+        static const int block = 64;
+
+        Scalar _w[block];
+        Scalar _v[block];
+        int _n = 0;
+        Real _sum = Real(0);
+
+        void flush()
+        {
+          typedef Eigen::Array<Scalar, Eigen::Dynamic, 1> array_type;
+          _sum += Log::weighted_log_sum(Eigen::Map<const array_type>(_w, _n),
+              Eigen::Map<const array_type>(_v, _n));
+          _n = 0;
+        }
+
+      public:
+        void add(Scalar w, Scalar v)
+        {
+          _w[_n] = w;
+          _v[_n] = v;
+          if(++_n == block)
+            flush();
+        }
+
+        Real sum()
+        {
+          flush();
+          return _sum;
+        }
+      };
+    }
+
+    /**
+     * @addtogroup IT
+     * @{
+     */
+
+    /**
+     * @brief Entropy of a sparse distribution, runs over the stored
+     * probabilities only
+     */
+    template<typename Log = precise_log, typename Scalar, typename ...T,
+    typename Executor = serial_executor>
+    typename prob::core::real_scalar<Scalar>::type
+    entropy(const sparse_distribution<Scalar, T...>& dist,
+        const Executor& = Executor())
+    {
+      static_assert(!sparse_distribution<Scalar, T...>::conditional_distribution(),
+          "Cannot calculate entropy of a conditional distribution");
+
+      core::weighted_log_buffer<Log, Scalar> sum;
+      for(const auto& e : dist.storage())
+        sum.add(e.second, e.second);
+
+      return -sum.sum() / log_of_2<typename prob::core::real_scalar<Scalar>::type>();
+    }
+
+    /**
+     * @brief Conditional entropy @f$ H(A|B) @f$ of sparse distributions
+     * @f$ p(a...|b...) @f$ and @f$ p(b...) @f$
+     */
+    template<typename Log = precise_log, typename Scalar, typename ...AgB,
+    typename ...B, typename Executor = serial_executor>
+    typename prob::core::real_scalar<Scalar>::type
+    conditional_entropy(const sparse_distribution<Scalar, AgB...>& dAgB,
+        const sparse_distribution<Scalar, B...>& dB, const Executor& = Executor())
+    {
+      core::weighted_log_buffer<Log, Scalar> sum;
+      for(const auto& e : dAgB.storage())
+        sum.add(e.second * dB.at(dAgB.row(e.first)), e.second);
+
+      return -sum.sum() / log_of_2<typename prob::core::real_scalar<Scalar>::type>();
+    }
+
+    /**
+     * @brief Mutual information @f$ I(A;B) @f$ of sparse distributions
+     * @f$ p(a...|b...) @f$ and @f$ p(b...) @f$
+     *
+     * The marginal @f$ p(a...) @f$ is accumulated over the stored
+     * probabilities in a first pass.
+     */
+    template<typename Log = precise_log, typename Scalar, typename ...AgB,
+    typename ...B, typename Executor = serial_executor>
+    typename prob::core::real_scalar<Scalar>::type
+    mutual_information(const sparse_distribution<Scalar, AgB...>& dAgB,
+        const sparse_distribution<Scalar, B...>& dB, const Executor& = Executor())
+    {
+      std::unordered_map<typename sparse_distribution<Scalar, AgB...>::key_type, Scalar> pA;
+      for(const auto& e : dAgB.storage())
+        pA[dAgB.col(e.first)] += e.second * dB.at(dAgB.row(e.first));
+
+      core::weighted_log_buffer<Log, Scalar> sum;
+      for(const auto& e : dAgB.storage())
+        sum.add(e.second * dB.at(dAgB.row(e.first)),
+            e.second / pA[dAgB.col(e.first)]);
+
+      return sum.sum() / log_of_2<typename prob::core::real_scalar<Scalar>::type>();
+    }
+
+    /** @} */
+  }
+}
+
+#endif /* _IT_SPARSE_H_ */
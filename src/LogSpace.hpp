@@ -0,0 +1,289 @@
+#ifndef _LOGSPACE_H_
+#define _LOGSPACE_H_
+
+#include <cmath>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+
+/**
+ * @file LogSpace.hpp
+ *
+ * @brief A scalar type storing probabilities by their logarithm
+ */
+
+namespace prob
+{
+  /**
+   * @brief A probability stored as its natural logarithm
+   *
+   * Behaves like the probability it represents, i.e. it is constructed
+   * from and compares as a probability, but products are sums of
+   * logarithms and sums are evaluated as log-sum-exp. Used as Scalar of a
+   * distribution, products of long chains of small probabilities (join,
+   * uncondition, partial_uncondition, bayes, ...) do not underflow, e.g.
+   *
+   * @code
+   * typedef prob::logspace<double> lp;
+   * distribution<lp, X, given, Y> pXgY = ...;
+   * distribution<lp, X, Y> pXY = uncondition(pXgY, pY);
+   * double h = it::entropy(pXY);
+   * @endcode
+   *
+   * All functions of the algebra work on such distributions without
+   * renormalization in between, marginalizations are vectorized
+   * log-sum-exp reductions and the information theoretic functions
+   * (entropy, conditional_entropy, mutual_information,
+   * conditional_mutual_information, kl_divergence, js_divergence) read the
+   * logarithms directly and return Real. Conversions from and to plain
+   * distributions are done with \ref distribution::scalar_cast.
+   *
+   * Differences are only defined if the result is not negative.
+   *
+   * @tparam Real Floating point type of the logarithm
+   */
+  template<typename Real>
+  class logspace
+  {
+    static_assert(std::is_floating_point<Real>::value,
+        "logspace requires a floating point type");
+
+    Real _log;
+
+    static Real log_add(Real a, Real b)
+    {
+      if(a < b)
+        std::swap(a, b);
+      if(b == -std::numeric_limits<Real>::infinity())
+        return a;
+      return a + std::log1p(std::exp(b - a));
+    }
+
+    static Real log_subtract(Real a, Real b)
+    {
+      if(b == -std::numeric_limits<Real>::infinity())
+        return a;
+      return a + std::log1p(-std::exp(b - a));
+    }
+
+  public:
+    typedef Real real_type;
+
+    /** @brief Probability 0 */
+    logspace() :
+        _log(-std::numeric_limits<Real>::infinity())
+    {
+    }
+
+    /** @brief The probability p, implicit such that literals can be used */
+    logspace(Real p) :
+        _log(std::log(p))
+    {
+    }
+
+    /** @brief The probability with the natural logarithm l */
+    static logspace from_log(Real l)
+    {
+      logspace v;
+      v._log = l;
+      return v;
+    }
+
+    /** @brief The natural logarithm of the probability */
+    Real log() const
+    {
+      return _log;
+    }
+
+    /** @brief The probability */
+    Real value() const
+    {
+      return std::exp(_log);
+    }
+
+    /** @brief The probability, see value() */
+    explicit operator Real() const
+    {
+      return value();
+    }
+
+    logspace& operator+=(const logspace& o)
+    {
+      _log = log_add(_log, o._log);
+      return *this;
+    }
+
+    logspace& operator-=(const logspace& o)
+    {
+      _log = log_subtract(_log, o._log);
+      return *this;
+    }
+
+    logspace& operator*=(const logspace& o)
+    {
+      _log += o._log;
+      return *this;
+    }
+
+    logspace& operator/=(const logspace& o)
+    {
+      _log -= o._log;
+      return *this;
+    }
+
+    friend logspace operator+(logspace a, const logspace& b) { return a += b; }
+    friend logspace operator-(logspace a, const logspace& b) { return a -= b; }
+    friend logspace operator*(logspace a, const logspace& b) { return a *= b; }
+    friend logspace operator/(logspace a, const logspace& b) { return a /= b; }
+
+    friend bool operator==(const logspace& a, const logspace& b) { return a._log == b._log; }
+    friend bool operator!=(const logspace& a, const logspace& b) { return a._log != b._log; }
+    friend bool operator<(const logspace& a, const logspace& b) { return a._log < b._log; }
+    friend bool operator>(const logspace& a, const logspace& b) { return a._log > b._log; }
+    friend bool operator<=(const logspace& a, const logspace& b) { return a._log <= b._log; }
+    friend bool operator>=(const logspace& a, const logspace& b) { return a._log >= b._log; }
+
+    friend std::ostream& operator<<(std::ostream& out, const logspace& v)
+    {
+      return out << v.value();
+    }
+  };
+
+  namespace core
+  {
+    /**
+     * @brief The information measures of \ref logspace probabilities are
+     * real numbers
+     */
+    template<typename Real>
+    struct real_scalar<logspace<Real>>
+    {
+      typedef typename real_scalar<Real>::type type;
+    };
+
+    /** @brief Natural logarithm of a \ref logspace value as Result */
+    template<typename Result>
+    struct logspace_log_functor
+    {
+      template<typename Real>
+      Result operator()(const logspace<Real>& v) const
+      {
+        return Result(v.log());
+      }
+    };
+
+    /** @brief Probability of a \ref logspace value as Result */
+    template<typename Result>
+    struct logspace_value_functor
+    {
+      template<typename Real>
+      Result operator()(const logspace<Real>& v) const
+      {
+        return Result(v.value());
+      }
+    };
+
+    /**
+     * @brief The logarithms of a buffer of \ref logspace values
+     *
+     * The buffer is reinterpreted, a logspace<Real> is laid out as a Real.
+     */
+    template<typename Real>
+    const Real* logarithms(const logspace<Real>* values)
+    {
+      static_assert(sizeof(logspace<Real>) == sizeof(Real),
+          "logspace needs to be laid out as its logarithm");
+      return reinterpret_cast<const Real*>(values);
+    }
+
+    /** @copydoc logarithms(const logspace<Real>*) */
+    template<typename Real>
+    Real* logarithms(logspace<Real>* values)
+    {
+      static_assert(sizeof(logspace<Real>) == sizeof(Real),
+          "logspace needs to be laid out as its logarithm");
+      return reinterpret_cast<Real*>(values);
+    }
+
+    /**
+     * @brief log(sum(exp(l))) of the logarithms l
+     *
+     * Shifted by the maximum, the exponentials and the sum are
+     * vectorized Eigen array operations.
+     */
+    template<typename Derived>
+    typename Derived::Scalar log_sum_exp(const Eigen::ArrayBase<Derived>& l)
+    {
+      typedef typename Derived::Scalar Real;
+
+      if(l.size() == 0)
+        return -std::numeric_limits<Real>::infinity();
+
+      Real m = l.maxCoeff();
+      if(m == -std::numeric_limits<Real>::infinity())
+        return m;
+
+      return m + std::log((l - m).exp().sum());
+    }
+
+    /**
+     * @brief acc = log(exp(acc) + exp(l)) cellwise, vectorized
+     */
+    template<typename Acc, typename Derived>
+    void log_add_exp(Eigen::ArrayBase<Acc>& acc, const Eigen::ArrayBase<Derived>& l)
+    {
+      typedef typename Derived::Scalar Real;
+      static const Real ninf = -std::numeric_limits<Real>::infinity();
+
+      auto m = acc.max(l);
+      acc = (m == ninf).select(ninf,
+          m + ((acc - m).exp() + (l - m).exp()).log());
+    }
+  }
+}
+
+namespace Eigen
+{
+  /** @brief Eigen scalar traits of \ref prob::logspace */
+  template<typename Real>
+  struct NumTraits<prob::logspace<Real>> : GenericNumTraits<prob::logspace<Real>>
+  {
+    enum
+    {
+      IsComplex = 0,
+      IsInteger = 0,
+      IsSigned = 0,
+      RequireInitialization = 1,
+      ReadCost = 1,
+      AddCost = 10,
+      MulCost = 1
+    };
+
+    static inline prob::logspace<Real> epsilon()
+    {
+      return NumTraits<Real>::epsilon();
+    }
+
+    static inline prob::logspace<Real> dummy_precision()
+    {
+      return NumTraits<Real>::dummy_precision();
+    }
+
+    static inline prob::logspace<Real> highest()
+    {
+      return prob::logspace<Real>::from_log(NumTraits<Real>::highest());
+    }
+
+    static inline prob::logspace<Real> lowest()
+    {
+      return prob::logspace<Real>();
+    }
+
+    static inline int digits10()
+    {
+      return NumTraits<Real>::digits10();
+    }
+  };
+}
+
+#endif /* _LOGSPACE_H_ */
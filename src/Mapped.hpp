@@ -0,0 +1,351 @@
+#ifndef _MAPPED_H_
+#define _MAPPED_H_
+
+#include <cstring>
+#include <fstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#ifndef PROB_HAS_MMAP
+#if defined(__unix__) || defined(__APPLE__)
+/**
+ * @brief Map files with mmap, otherwise mapped distributions read the
+ * whole file into memory
+ */
+#define PROB_HAS_MMAP 1
+#else
+#define PROB_HAS_MMAP 0
+#endif
+#endif
+
+#if PROB_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @file Mapped.hpp
+ *
+ * @brief Read only distributions backed by a memory mapped file
+ */
+
+namespace prob
+{
+  namespace core
+  {
+    /**
+     * @brief A read only mapping of a whole file
+     *
+     * Uses mmap if available (#PROB_HAS_MMAP), otherwise the file is read
+     * into a buffer.
+     */
+    class file_mapping
+    {
+    public:
+      file_mapping()
+      {
+      }
+
+      file_mapping(const file_mapping&) = delete;
+      file_mapping& operator=(const file_mapping&) = delete;
+
+      ~file_mapping()
+      {
+        close();
+      }
+
+      /** @brief Map the file at path, false if it cannot be mapped */
+      bool open(const std::string& path)
+      {
+        close();
+
+#if PROB_HAS_MMAP
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0)
+          return false;
+
+        struct stat st;
+        if(::fstat(fd, &st) != 0 || st.st_size == 0)
+        {
+          ::close(fd);
+          return false;
+        }
+
+        void* p = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if(p == MAP_FAILED)
+          return false;
+
+        _data = static_cast<const char*>(p);
+        _size = st.st_size;
+#else
+        std::ifstream in(path, std::ios::binary);
+        _buffer.assign(std::istreambuf_iterator<char>(in),
+            std::istreambuf_iterator<char>());
+        if(_buffer.empty())
+          return false;
+
+        _data = _buffer.data();
+        _size = _buffer.size();
+#endif
+        return true;
+      }
+
+      void close()
+      {
+#if PROB_HAS_MMAP
+        if(_data)
+          ::munmap(const_cast<char*>(_data), _size);
+#else
+        _buffer.clear();
+#endif
+        _data = nullptr;
+        _size = 0;
+      }
+
+      const char* data() const
+      {
+        return _data;
+      }
+
+      std::size_t size() const
+      {
+        return _size;
+      }
+
+    private:
+      const char* _data = nullptr;
+      std::size_t _size = 0;
+#if !PROB_HAS_MMAP
+      std::vector<char> _buffer;
+#endif
+    };
+
+    /** @brief A read only std::streambuf over a memory range */
+    struct memory_streambuf : std::streambuf
+    {
+      memory_streambuf(const char* data, std::size_t size)
+      {
+        char* p = const_cast<char*>(data);
+        setg(p, p, p + size);
+      }
+    };
+  }
+
+  /**
+   * @brief A read only distribution over the buffer of a file in the
+   * binary format (see \ref distribution::save_binary)
+   *
+   * The file is memory mapped and the backing matrix is an Eigen::Map
+   * directly over the mapped buffer, nothing is loaded upfront. The pages
+   * that are accessed are read (and cached) by the operating system, hence
+   * tables larger than the main memory can be used.
+   *
+   * @code
+   * pXgY.save_binary(out);
+   * ...
+   * mapped_distribution<double, X, given, Y> mXgY("pXgY.prob");
+   * if(mXgY.is_open())
+   *   double h = it::conditional_entropy(mXgY, mY);
+   * @endcode
+   *
+   * Element access, each_index, marginalize (\ref distribution::grouped_map_sum)
+   * and the information theoretic functions work as on \ref distribution,
+   * marginals are returned as (owning) distributions. The file needs to
+   * have the scalar type and storage layout of the distribution, and is
+   * written in version 2 of the format or later (or its buffer happens to
+   * be aligned). Otherwise it is not opened.
+   */
+  template<typename Scalar, typename ...T>
+  class mapped_distribution : public Eigen::Map<const typename distribution<Scalar, T...>::matrix_type>
+  {
+  public:
+    typedef distribution<Scalar, T...> dense_type;
+    typedef typename dense_type::matrix_type matrix_type;
+    typedef Eigen::Map<const matrix_type> map_type;
+    typedef Scalar scalar;
+
+    typedef typename dense_type::row_type row_type;
+    typedef typename dense_type::col_type col_type;
+    typedef typename dense_type::row_strides_type row_strides_type;
+    typedef typename dense_type::col_strides_type col_strides_type;
+    typedef typename dense_type::conditional_type conditional_type;
+    typedef typename dense_type::posterior_type posterior_type;
+    typedef typename dense_type::expanded_type expanded_type;
+
+    /**
+     * @brief Variable type to distribution type conversion
+     *
+     * Results of marginalizations are owning distributions.
+     */
+    template<typename _T>
+    struct type_to_distribution : dense_type::template type_to_distribution<_T>
+    {
+    };
+
+  private:
+    static constexpr bool _conditional_distribution =
+        core::splitter<T...>::conditional_distribution;
+
+    template <bool> friend struct core::conditional_case;
+    template <bool, bool, size_t, typename...> friend struct core::element_offset;
+    core::conditional_case<_conditional_distribution> cased;
+
+    row_type _row_extents;
+    col_type _col_extents;
+
+    row_strides_type _row_strides;
+    col_strides_type _col_strides;
+
+    core::file_mapping _mapping;
+
+    static constexpr int initial_rows =
+        matrix_type::RowsAtCompileTime == Eigen::Dynamic ? 0 : matrix_type::RowsAtCompileTime;
+    static constexpr int initial_cols =
+        matrix_type::ColsAtCompileTime == Eigen::Dynamic ? 0 : matrix_type::ColsAtCompileTime;
+
+    /** @brief Check the header and point the Eigen::Map at the buffer */
+    bool map(const std::string& path)
+    {
+      static constexpr size_t P = posterior_type::dim;
+
+      if(!_mapping.open(path))
+        return false;
+
+      core::memory_streambuf buffer(_mapping.data(), _mapping.size());
+      std::istream in(&buffer);
+
+      core::binary_header header;
+      if(!header.read(in, posterior_type::dim + conditional_type::dim) ||
+          !header.template matches<posterior_type, conditional_type>() ||
+          header.kind != core::binary_scalar_kind<Scalar>() ||
+          header.scalar_size != sizeof(Scalar) ||
+          header.row_major != (matrix_type::IsRowMajor ? 1 : 0) ||
+          !header.consistent_extents())
+        return false;
+
+      // Divided instead of multiplied, a crafted header must not overflow
+      // the size check
+      std::size_t offset = header.bytes();
+      if(offset % alignof(Scalar) != 0 || offset > _mapping.size() || header.cols == 0 ||
+          header.rows > (_mapping.size() - offset) / sizeof(Scalar) / header.cols)
+        return false;
+
+      row_type row_extents = core::extent_tuple<row_type>::build(header.extents.data() + P);
+      col_type col_extents = core::extent_tuple<col_type>::build(header.extents.data());
+
+      if(extents_assert<T...>::is_static() &&
+          (core::extent_array(row_extents) != core::extent_array(_row_extents) ||
+          core::extent_array(col_extents) != core::extent_array(_col_extents)))
+        return false;
+
+      _row_extents = row_extents;
+      _col_extents = col_extents;
+      int rows = core::stride_builder<0, conditional_type::dim>::build(_row_extents, _row_strides);
+      int cols = core::stride_builder<0, posterior_type::dim>::build(_col_extents, _col_strides);
+
+      // Eigen::Map is reseated by placement new
+      new (static_cast<map_type*>(this)) map_type(
+          reinterpret_cast<const Scalar*>(_mapping.data() + offset), rows, cols);
+      return true;
+    }
+
+  public:
+    /**
+     * @brief Map the distribution stored in the file at path
+     *
+     * Check is_open() whether the file was mapped.
+     */
+    explicit mapped_distribution(const std::string& path) :
+        map_type(nullptr, initial_rows, initial_cols),
+        _row_extents(core::static_row_extents<T...>::extents()),
+        _col_extents(core::static_col_extents<T...>::extents())
+    {
+      if(!map(path))
+        _mapping.close();
+    }
+
+    mapped_distribution(const mapped_distribution&) = delete;
+    mapped_distribution& operator=(const mapped_distribution&) = delete;
+
+    /** @brief Was the file mapped? */
+    bool is_open() const
+    {
+      return this->data() != nullptr;
+    }
+
+    /** @brief See \ref distribution::conditional_distribution */
+    static constexpr bool conditional_distribution()
+    {
+      return _conditional_distribution;
+    }
+
+    /** @brief Extents of the conditional variables as a tuple */
+    row_type row_extents() const { return _row_extents; }
+    /** @brief Extents of the posterior variables as a tuple */
+    col_type col_extents() const { return _col_extents; }
+    /** @brief Strides of the conditional variables */
+    const row_strides_type& row_strides() const { return _row_strides; }
+    /** @brief Strides of the posterior variables */
+    const col_strides_type& col_strides() const { return _col_strides; }
+
+    /** @brief Read a probability value, see \ref distribution::operator() */
+    template<typename... _T>
+    Scalar operator()(_T... t) const
+    {
+      typedef core::splitter<typename std::decay<_T>::type...> local_splitter;
+
+      static_assert(util::traits::are_equivalent<
+          typename local_splitter::expanded_type, T...>::value,
+          "Random variable type mismatch");
+
+      int row = 0, col = 0;
+      core::element_offset<false, false, 0,
+          typename std::decay<_T>::type...>::accumulate(*this, row, col, t...);
+
+      return map_type::operator()(row, col);
+    }
+
+    /** @brief See \ref distribution::each_index */
+    template<typename F>
+    void each_index(F f) const
+    {
+      cased.each_index(*this, f);
+    }
+
+    /** @brief See \ref distribution::each_index */
+    template<typename F, typename Executor>
+    void each_index(F f, const Executor& ex) const
+    {
+      cased.each_index(*this, f, ex);
+    }
+
+    /** @brief See \ref distribution::grouped_map_sum */
+    template<int... GroupIndices, typename F, typename Executor = serial_executor>
+    auto grouped_map_sum(F f, const Executor& ex = Executor()) const  ->
+    typename core::grouped_map_sum_impl<mapped_distribution, GroupIndices...>::result_type
+    {
+      return core::grouped_map_sum_impl<mapped_distribution, GroupIndices...>::apply(
+          *this, f, ex);
+    }
+
+    /** @brief See \ref distribution::marginalize */
+    template<int... GroupIndices, typename Executor = serial_executor>
+    auto marginalize(const Executor& ex = Executor()) const ->
+    typename core::grouped_map_sum_impl<mapped_distribution, GroupIndices...>::result_type
+    {
+      return grouped_map_sum<GroupIndices...>(core::identity_functor(), ex);
+    }
+
+    /** @brief Copy into an owning distribution */
+    dense_type to_distribution() const
+    {
+      return dense_type(matrix_type(*this), _row_extents, _col_extents);
+    }
+  };
+}
+
+#endif /* _MAPPED_H_ */
@@ -0,0 +1,335 @@
+#ifndef _PARALLEL_H_
+#define _PARALLEL_H_
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @file Parallel.hpp
+ *
+ * @brief Executors, splitting index ranges across threads
+ *
+ * An executor is any type providing
+ *
+ * @code
+ * unsigned concurrency() const;
+ * template<typename F> void parallel_for(int begin, int end, F&& f) const;
+ * @endcode
+ *
+ * where parallel_for calls f(chunk_begin, chunk_end) on disjoint chunks
+ * covering [begin, end) and returns once all chunks are processed. The
+ * heavy operations of the library take an executor as an optional last
+ * argument, by default they run on the calling thread (\ref serial_executor).
+ */
+
+namespace prob
+{
+  namespace core
+  {
+    /**
+     * @brief The number of threads used if none is requested explicitly
+     */
+    inline unsigned default_thread_count()
+    {
+      unsigned n = std::thread::hardware_concurrency();
+      return n > 0 ? n : 1;
+    }
+
+    /**
+     * @brief Begin of the chunk c when splitting n indices into the given
+     * number of chunks, the first n % chunks chunks are one index larger
+     */
+    inline int chunk_begin(int n, int chunks, int c)
+    {
+      return c * (n / chunks) + std::min(c, n % chunks);
+    }
+
+    /**
+     * @brief Split the range [begin, end) into contiguous chunks and call
+     * f(chunk_begin, chunk_end) for each chunk on its own thread
+     *
+     * The calling thread processes the last chunk itself. If only one
+     * chunk remains f is called directly without spawning any thread.
+     *
+     * @param begin First index of the range
+     * @param end One past the last index of the range
+     * @param threads Maximal number of threads, 0 uses
+     * \ref default_thread_count
+     * @param f Callable (int, int) -> void
+     */
+    template<typename F>
+    void parallel_for(int begin, int end, unsigned threads, F f)
+    {
+      if(threads == 0)
+        threads = default_thread_count();
+
+      int n = end - begin;
+      if(n <= 0)
+        return;
+
+      int chunks = std::min<int>(threads, n);
+      if(chunks == 1)
+      {
+        f(begin, end);
+        return;
+      }
+
+      std::vector<std::thread> workers;
+      workers.reserve(chunks - 1);
+
+      for(int c = 0; c < chunks - 1; ++c)
+      {
+        int b = begin + chunk_begin(n, chunks, c);
+        int e = begin + chunk_begin(n, chunks, c + 1);
+        workers.emplace_back([&f, b, e] () { f(b, e); });
+      }
+
+      f(begin + chunk_begin(n, chunks, chunks - 1), end);
+
+      for(auto& w : workers)
+        w.join();
+    }
+
+    /**
+     * @brief Whether T provides the executor interface
+     *
+     * Used to tell an optional executor argument apart from a distribution
+     * argument in overloaded functions.
+     */
+    template<typename T>
+    struct is_executor
+    {
+    private:
+      template<typename U>
+      static auto test(int) -> decltype(std::declval<const U&>().concurrency(), std::true_type());
+
+      template<typename U>
+      static std::false_type test(...);
+
+    public:
+      static constexpr bool value = decltype(test<T>(0))::value;
+    };
+
+    /**
+     * @brief Executor spawning fresh threads on each call
+     *
+     * Backs the parallel_* convenience methods that only take a thread count.
+     */
+    class thread_spawner
+    {
+    public:
+      explicit thread_spawner(unsigned threads = 0) :
+          _threads(threads == 0 ? default_thread_count() : threads)
+      {
+      }
+
+      unsigned concurrency() const
+      {
+        return _threads;
+      }
+
+      template<typename F>
+      void parallel_for(int begin, int end, F&& f) const
+      {
+        core::parallel_for(begin, end, _threads, std::ref(f));
+      }
+
+    private:
+      unsigned _threads;
+    };
+
+    /**
+     * @brief Sum of f(chunk_begin, chunk_end) over chunks of [begin, end)
+     * evaluated on an executor
+     *
+     * The range is split into ex.concurrency() chunks and the partial sums
+     * are added up in chunk order, hence the result does not depend on
+     * the scheduling.
+     */
+    template<typename Scalar, typename Executor, typename F>
+    Scalar parallel_sum(const Executor& ex, int begin, int end, F f)
+    {
+      int n = end - begin;
+      if(n <= 0)
+        return Scalar(0);
+
+      int chunks = std::min<int>(ex.concurrency(), n);
+      if(chunks <= 1)
+        return f(begin, end);
+
+      std::vector<Scalar> partial(chunks, Scalar(0));
+      ex.parallel_for(0, chunks,
+          [&] (int cb, int ce)
+          {
+            for(int c = cb; c < ce; ++c)
+              partial[c] = f(begin + chunk_begin(n, chunks, c),
+                  begin + chunk_begin(n, chunks, c + 1));
+          });
+
+      Scalar sum(0);
+      for(int c = 0; c < chunks; ++c)
+        sum += partial[c];
+      return sum;
+    }
+  }
+
+  /**
+   * @brief Executor running everything on the calling thread
+   *
+   * The default executor of all operations.
+   */
+  struct serial_executor
+  {
+    unsigned concurrency() const
+    {
+      return 1;
+    }
+
+    template<typename F>
+    void parallel_for(int begin, int end, F&& f) const
+    {
+      if(end > begin)
+        f(begin, end);
+    }
+  };
+
+  /**
+   * @brief A fixed set of worker threads shared by all operations it is
+   * passed to
+   *
+   * parallel_for splits the range into one chunk per thread and queues the
+   * chunks. The calling thread works on queued chunks as well until its
+   * own chunks are done, so parallel_for may be nested (e.g. a map inside
+   * a parallel each_index) without deadlocking the pool. The functions
+   * passed to parallel_for must not throw.
+   *
+   * @code
+   * prob::thread_pool pool(8);
+   * auto pX = pXY.marginalize<0>(pool);
+   * auto pXY = prob::join(pX, pY, pool);
+   * @endcode
+   */
+  class thread_pool
+  {
+  public:
+    /**
+     * @param threads Total number of threads including the calling thread,
+     * 0 uses all hardware threads
+     */
+    explicit thread_pool(unsigned threads = 0) :
+        _stop(false)
+    {
+      if(threads == 0)
+        threads = core::default_thread_count();
+
+      for(unsigned i = 1; i < threads; ++i)
+        _workers.emplace_back([this] () { work(); });
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    ~thread_pool()
+    {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+      }
+      _wake.notify_all();
+      for(auto& w : _workers)
+        w.join();
+    }
+
+    unsigned concurrency() const
+    {
+      return _workers.size() + 1;
+    }
+
+    template<typename F>
+    void parallel_for(int begin, int end, F&& f) const
+    {
+      int n = end - begin;
+      if(n <= 0)
+        return;
+
+      int chunks = std::min<int>(concurrency(), n);
+      if(chunks == 1)
+      {
+        f(begin, end);
+        return;
+      }
+
+      int remaining = chunks - 1;
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for(int c = 0; c < chunks - 1; ++c)
+        {
+          int b = begin + core::chunk_begin(n, chunks, c);
+          int e = begin + core::chunk_begin(n, chunks, c + 1);
+          _tasks.push_back([this, &f, &remaining, b, e] ()
+              {
+                f(b, e);
+                std::lock_guard<std::mutex> lock(_mutex);
+                --remaining;
+                _done.notify_all();
+              });
+        }
+      }
+      _wake.notify_all();
+
+      f(begin + core::chunk_begin(n, chunks, chunks - 1), end);
+
+      // Help with queued work until all chunks of this call are done
+      std::unique_lock<std::mutex> lock(_mutex);
+      while(remaining > 0)
+      {
+        if(!_tasks.empty())
+        {
+          std::function<void()> task = std::move(_tasks.front());
+          _tasks.pop_front();
+          lock.unlock();
+          task();
+          lock.lock();
+        }
+        else
+        {
+          _done.wait(lock);
+        }
+      }
+    }
+
+  private:
+    void work() const
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      while(true)
+      {
+        _wake.wait(lock, [this] () { return _stop || !_tasks.empty(); });
+        if(_tasks.empty())
+          return;
+
+        std::function<void()> task = std::move(_tasks.front());
+        _tasks.pop_front();
+        lock.unlock();
+        task();
+        lock.lock();
+      }
+    }
+
+    std::vector<std::thread> _workers;
+    mutable std::deque<std::function<void()>> _tasks;
+    mutable std::mutex _mutex;
+    mutable std::condition_variable _wake;
+    mutable std::condition_variable _done;
+    bool _stop;
+  };
+}
+
+#endif /* _PARALLEL_H_ */
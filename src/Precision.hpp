@@ -0,0 +1,59 @@
+#ifndef _PRECISION_H_
+#define _PRECISION_H_
+
+/**
+ * @file Precision.hpp
+ *
+ * @brief Accumulation types of reductions over distributions
+ */
+
+#ifndef PROB_MIXED_PRECISION
+/**
+ * @brief Accumulate the reductions over float distributions in double
+ *
+ * With mixed precision (the default) float distributions are stored and
+ * read as float, i.e. at half the memory bandwidth of double, but sum,
+ * normalize, marginalize and the information theoretic functions
+ * accumulate in double and the information measures are returned as
+ * double. Define as 0 to run float distributions entirely in float.
+ */
+#define PROB_MIXED_PRECISION 1
+#endif
+
+namespace prob
+{
+  namespace core
+  {
+    /**
+     * @brief The type sums over probabilities of type Scalar are
+     * accumulated in
+     */
+    template<typename Scalar>
+    struct accumulator
+    {
+      typedef Scalar type;
+    };
+
+#if PROB_MIXED_PRECISION
+    /** @cond PRIVATE */
+    template<>
+    struct accumulator<float>
+    {
+      typedef double type;
+    };
+    /** @endcond */
+#endif
+
+    /**
+     * @brief The real type of the information measures of probabilities of
+     * type Scalar
+     */
+    template<typename Scalar>
+    struct real_scalar
+    {
+      typedef typename accumulator<Scalar>::type type;
+    };
+  }
+}
+
+#endif /* _PRECISION_H_ */
@@ -2,6 +2,7 @@
 #define _RANDOMVARIABLE_H_
 
 #include "prob.hpp"
+#include <array>
 
 /**
  * @file RandomVariable.hpp
@@ -578,61 +579,135 @@ namespace prob
 
     /**
      * @brief Used to iterate a function over all indices given specific extents
+     *
+     * The loops over the indices are generated at compile time, one plain
+     * counted loop per variable. The indices are handed down as integers and
+     * the random events are only constructed for the call of f, hence no
+     * index tuple is built and the compiler sees an ordinary loop nest. The
+     * _offset variants additionally pass the linear offset of each cell as
+     * first argument to f, the offset is advanced by the storage stride of
+     * every index (e.g. the position in the buffer of a distribution).
      */
     template<typename Head, typename ...Tail, template<typename ...> class T>
     struct index_iterator<T<Head, Tail...>>
     {
-      template<typename F, typename... Index,
-      typename ExtentHead, typename... ExtentTail,
-      template<typename ...> class E,
-      template <typename...> class I = std::tuple>
-      static void apply_all(F&& f,
-          const I<Index...>& idx,
-          const E<ExtentHead, ExtentTail...>& extents)
+      static constexpr size_t N = 1 + sizeof...(Tail);
+
+      typedef std::array<int, N> strides_type;
+
+    private:
+      /** @cond PRIVATE */
+      template<size_t D, typename Offset, typename Dummy = void>
+      struct loop
       {
-        unsigned headExtent = read_index<ExtentHead>::read(std::get<0>(extents));
-        for(unsigned i=0; i<headExtent; ++i)
+        template<typename F, typename ...I>
+        static void run(F& f, const int* ext, const int* strides, int offset,
+            int begin, int end, I... i)
         {
-          // Append the current index to the index tuple
-        	I<Index..., Head> new_idx = util::tuple::append(idx, Head(i));
-        	// And remove the current extent from the extent tuple
-          E<ExtentTail...> extent_tail = util::tuple::tail(extents);
-          // Recursively call apply
-          index_iterator<T<Tail...>>::apply_all(
-              f,
-              new_idx,
-              extent_tail
-          );
+          int stride = Offset::value ? strides[D] : 0;
+          for(int j = begin; j < end; ++j)
+            loop<D + 1, Offset>::run(f, ext, strides, offset + j * stride,
+                0, ext[D + 1], i..., j);
         }
-      }
-
-    };
+      };
 
-    template<template<typename ...> class T>
-    struct index_iterator<T<>>
-    {
-      /** @cond PRIVATE */
-      template<typename S>
-      struct apply_impl;
-      /** @endcond */
+      template<typename Dummy>
+      struct loop<N, std::false_type, Dummy>
+      {
+        template<typename F, typename ...I>
+        static void run(F& f, const int* ext, const int* strides, int offset,
+            int begin, int end, int head, I... tail)
+        {
+          f(Head(head), Tail(tail)...);
+        }
+      };
 
-      template<size_t ...IndexIterator>
-      struct apply_impl<util::compile_time_list::integer_list<IndexIterator...>>
+      template<typename Dummy>
+      struct loop<N, std::true_type, Dummy>
       {
-        template<typename ...Index, typename F,
-        template <typename...> class I = std::tuple>
-        static void apply(F && f, const I<Index...>& idx_tpl)
+        template<typename F, typename ...I>
+        static void run(F& f, const int* ext, const int* strides, int offset,
+            int begin, int end, int head, I... tail)
         {
-          f(std::forward<const Index>(std::get<IndexIterator>(idx_tpl))...);
+          f(offset, Head(head), Tail(tail)...);
         }
       };
 
-      template<typename F, typename... Index,
-      typename E,
+      template<size_t ...K, typename E>
+      static void read_extents(util::compile_time_list::integer_list<K...>,
+          const E& e, int* ext)
+      {
+        int read[] = { (ext[K] = read_index<typename std::decay<
+            decltype(std::get<K>(e))>::type>::read(std::get<K>(e)))... };
+        (void)read;
+      }
+      /** @endcond */
+
+      template<typename Offset, typename F, typename E>
+      static void iterate(F& f, const E& extents, const int* strides,
+          int begin, int end)
+      {
+        // The extent after the last variable is never looped over
+        int ext[N + 1] = { 0 };
+        read_extents(typename util::compile_time_list::iota_0<N>::type(),
+            extents, ext);
+
+        loop<0, Offset>::run(f, ext, strides, 0, begin, end);
+      }
+
+    public:
+      template<typename F, typename E, template <typename...> class I = std::tuple>
+      static void apply_all(F&& f, const I<>& idx, const E& extents)
+      {
+        typedef typename std::decay<decltype(std::get<0>(extents))>::type ExtentHead;
+        iterate<std::false_type>(f, extents, nullptr, 0,
+            read_index<ExtentHead>::read(std::get<0>(extents)));
+      }
+
+      /**
+       * @brief Like apply_all, but the outer most index only runs through
+       * [begin, end)
+       */
+      template<typename F, typename E>
+      static void apply_range(F&& f, const E& extents,
+          unsigned begin, unsigned end)
+      {
+        iterate<std::false_type>(f, extents, nullptr, begin, end);
+      }
+
+      /**
+       * @brief Like apply_all, f(offset, i...) additionally gets the sum of
+       * the indices times strides
+       */
+      template<typename F, typename E>
+      static void apply_all_offset(F&& f, const E& extents,
+          const strides_type& strides)
+      {
+        typedef typename std::decay<decltype(std::get<0>(extents))>::type ExtentHead;
+        iterate<std::true_type>(f, extents, strides.data(), 0,
+            read_index<ExtentHead>::read(std::get<0>(extents)));
+      }
+
+      /**
+       * @brief Like apply_all_offset, but the outer most index only runs
+       * through [begin, end)
+       */
+      template<typename F, typename E>
+      static void apply_range_offset(F&& f, const E& extents,
+          const strides_type& strides, unsigned begin, unsigned end)
+      {
+        iterate<std::true_type>(f, extents, strides.data(), begin, end);
+      }
+    };
+
+    template<template<typename ...> class T>
+    struct index_iterator<T<>>
+    {
+      template<typename F, typename E,
       template <typename...> class I = std::tuple>
-      static void apply_all(F && f, const I<Index...>& idx, const E& extents)
+      static void apply_all(F && f, const I<>& idx, const E& extents)
       {
-        apply_impl<typename util::compile_time_list::iota_0<sizeof...(Index)>::type>::apply(f, idx);
+        f();
       }
     };
 
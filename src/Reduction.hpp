@@ -0,0 +1,462 @@
+#ifndef _REDUCTION_H_
+#define _REDUCTION_H_
+
+#include <algorithm>
+#include <array>
+
+/**
+ * @file Reduction.hpp
+ *
+ * @brief Stride based reductions on raw matrix buffers
+ *
+ * Kernels that sum a multidimensional table over a subset of its axes
+ * directly on the storage of the backing Eigen matrices, given the extent
+ * of each axis and its stride in the source and the destination buffer,
+ * and the copy between two layouts of the same table.
+ */
+
+namespace prob
+{
+  namespace core
+  {
+    /**
+     * @brief Identity map, the map of a plain marginalization
+     *
+     * Used as a tag such that reductions without a map compile to a pure
+     * (vectorized) sum.
+     */
+    struct identity_functor
+    {
+      template<typename Scalar>
+      Scalar operator()(Scalar v) const
+      {
+        return v;
+      }
+    };
+
+    /**
+     * @brief An axis of a strided table
+     *
+     * A destination stride of 0 denotes an axis that is summed over.
+     */
+    struct strided_axis
+    {
+      int extent;
+      int src_stride;
+      int dst_stride;
+    };
+
+    /** @cond PRIVATE */
+    template<typename F>
+    struct strided_inner_kernel;
+    /** @endcond */
+
+    /**
+     * @brief The inner most loop of a strided reduction
+     *
+     * Contiguous sums and contiguous accumulations are handed to Eigen,
+     * everything else is a plain strided loop. The destination may have a
+     * wider scalar type Acc than the source, the mapped values are then
+     * converted before they are summed.
+     */
+    template<typename F>
+    struct strided_inner_kernel
+    {
+      template<typename Scalar, typename Acc>
+      static void apply(const Scalar* src, Acc* dst, const strided_axis& a, F& f)
+      {
+        typedef Eigen::Array<Scalar, Eigen::Dynamic, 1> array_type;
+        typedef Eigen::Array<Acc, Eigen::Dynamic, 1> acc_type;
+
+        if(a.src_stride == 1 && a.dst_stride == 0)
+          *dst += Eigen::Map<const array_type>(src, a.extent).unaryExpr(f)
+              .template cast<Acc>().sum();
+        else if(a.src_stride == 1 && a.dst_stride == 1)
+          Eigen::Map<acc_type>(dst, a.extent) +=
+              Eigen::Map<const array_type>(src, a.extent).unaryExpr(f)
+              .template cast<Acc>();
+        else
+          for(int i = 0; i < a.extent; ++i)
+            dst[i * a.dst_stride] += Acc(f(src[i * a.src_stride]));
+      }
+    };
+
+    /**
+     * @brief The inner most loop of a strided reduction without a map
+     */
+    template<>
+    struct strided_inner_kernel<identity_functor>
+    {
+      template<typename Scalar, typename Acc>
+      static void apply(const Scalar* src, Acc* dst, const strided_axis& a,
+          identity_functor& f)
+      {
+        typedef Eigen::Array<Scalar, Eigen::Dynamic, 1> array_type;
+        typedef Eigen::Array<Acc, Eigen::Dynamic, 1> acc_type;
+        typedef Eigen::InnerStride<Eigen::Dynamic> stride_type;
+
+        if(a.src_stride == 1 && a.dst_stride == 0)
+          *dst += Eigen::Map<const array_type>(src, a.extent).template cast<Acc>().sum();
+        else if(a.src_stride == 1 && a.dst_stride == 1)
+          Eigen::Map<acc_type>(dst, a.extent) +=
+              Eigen::Map<const array_type>(src, a.extent).template cast<Acc>();
+        else if(a.dst_stride == 0)
+          *dst += Eigen::Map<const array_type, 0, stride_type>(src, a.extent,
+              stride_type(a.src_stride)).template cast<Acc>().sum();
+        else
+          for(int i = 0; i < a.extent; ++i)
+            dst[i * a.dst_stride] += Acc(src[i * a.src_stride]);
+      }
+
+      /**
+       * @brief Log-sum-exp reduction of \ref logspace tables, directly on
+       * the logarithms
+       */
+      template<typename Real>
+      static void apply(const logspace<Real>* src, logspace<Real>* dst,
+          const strided_axis& a, identity_functor& f)
+      {
+        typedef Eigen::Array<Real, Eigen::Dynamic, 1> array_type;
+        typedef Eigen::InnerStride<Eigen::Dynamic> stride_type;
+
+        const Real* l = logarithms(src);
+
+        if(a.src_stride == 1 && a.dst_stride == 0)
+          *dst += logspace<Real>::from_log(
+              log_sum_exp(Eigen::Map<const array_type>(l, a.extent)));
+        else if(a.src_stride == 1 && a.dst_stride == 1)
+        {
+          Eigen::Map<array_type> acc(logarithms(dst), a.extent);
+          log_add_exp(acc, Eigen::Map<const array_type>(l, a.extent));
+        }
+        else if(a.dst_stride == 0)
+          *dst += logspace<Real>::from_log(log_sum_exp(
+              Eigen::Map<const array_type, 0, stride_type>(l, a.extent,
+              stride_type(a.src_stride))));
+        else
+        {
+          Eigen::Map<array_type, 0, stride_type> acc(logarithms(dst), a.extent,
+              stride_type(a.dst_stride));
+          log_add_exp(acc, Eigen::Map<const array_type, 0, stride_type>(l, a.extent,
+              stride_type(a.src_stride)));
+        }
+      }
+    };
+
+    /**
+     * @brief Sort and merge the axes of a strided reduction
+     *
+     * Axes of extent one are dropped, the remaining axes are ordered by
+     * decreasing source stride (the last axis being the inner most loop)
+     * and neighbouring axes that are contiguous in both buffers are merged
+     * into a single axis.
+     *
+     * @return The number of remaining axes
+     */
+    template<size_t N>
+    size_t strided_plan(std::array<strided_axis, N>& axes)
+    {
+      size_t n = 0;
+      for(size_t i = 0; i < N; ++i)
+        if(axes[i].extent > 1)
+          axes[n++] = axes[i];
+
+      // Insertion sort, there are only a few axes
+      for(size_t i = 1; i < n; ++i)
+        for(size_t j = i; j > 0 && axes[j - 1].src_stride < axes[j].src_stride; --j)
+          std::swap(axes[j - 1], axes[j]);
+
+      if(n < 2)
+        return n;
+
+      // Merge from the inside out
+      size_t m = n - 1;
+      for(size_t i = n - 1; i-- > 0;)
+      {
+        strided_axis& inner = axes[m];
+        const strided_axis& outer = axes[i];
+
+        if(outer.src_stride == inner.src_stride * inner.extent &&
+            outer.dst_stride == inner.dst_stride * inner.extent)
+        {
+          inner.extent *= outer.extent;
+        }
+        else
+        {
+          axes[--m] = outer;
+        }
+      }
+
+      // Shift the merged axes to the front
+      for(size_t i = m; i < n; ++i)
+        axes[i - m] = axes[i];
+
+      return n - m;
+    }
+
+    /**
+     * @brief Apply f to every element of a strided source table and add
+     * it to the corresponding element of the destination table
+     *
+     * The destination is not cleared, i.e. the results are accumulated.
+     *
+     * @param src Pointer to the first element of the source table
+     * @param dst Pointer to the first element of the destination table,
+     * its scalar type may be wider than the one of the source
+     * @param axes Extents and source/destination strides of all axes
+     * @param f Map applied to each source element
+     */
+    template<typename Scalar, typename Acc, size_t N, typename F>
+    void strided_map_sum(const Scalar* src, Acc* dst,
+        std::array<strided_axis, N> axes, F f)
+    {
+      size_t n = strided_plan(axes);
+
+      if(n == 0)
+      {
+        *dst += Acc(f(*src));
+        return;
+      }
+
+      const strided_axis& inner = axes[n - 1];
+      std::array<int, N> counter;
+      counter.fill(0);
+
+      int src_offset = 0, dst_offset = 0;
+
+      while(true)
+      {
+        strided_inner_kernel<F>::apply(src + src_offset, dst + dst_offset, inner, f);
+
+        // Odometer increment of the outer axes
+        size_t k = n - 1;
+        while(k > 0)
+        {
+          --k;
+          src_offset += axes[k].src_stride;
+          dst_offset += axes[k].dst_stride;
+          if(++counter[k] < axes[k].extent)
+            break;
+
+          src_offset -= axes[k].src_stride * axes[k].extent;
+          dst_offset -= axes[k].dst_stride * axes[k].extent;
+          counter[k] = 0;
+
+          if(k == 0)
+            return;
+        }
+
+        if(n == 1)
+          return;
+      }
+    }
+
+    /**
+     * @brief strided_map_sum on an executor
+     *
+     * parallel_for splits the outer loop axis of the plan (see
+     * \ref strided_plan, axes ordered by decreasing source stride) that is
+     * kept in the destination, i.e. the first planned axis with a non-zero
+     * destination stride. Summed axes before it are iterated by every chunk.
+     * Different chunks write to disjoint cells of the destination, hence
+     * they can run concurrently. Full sums to a single cell run serially.
+     */
+    template<typename Scalar, typename Acc, size_t N, typename F, typename Executor>
+    void strided_map_sum(const Scalar* src, Acc* dst,
+        std::array<strided_axis, N> axes, F f, const Executor& ex)
+    {
+      if(ex.concurrency() < 2)
+      {
+        strided_map_sum(src, dst, axes, f);
+        return;
+      }
+
+      size_t n = strided_plan(axes);
+
+      size_t k = 0;
+      while(k < n && axes[k].dst_stride == 0)
+        ++k;
+
+      if(k == n)
+      {
+        for(size_t i = n; i < N; ++i)
+          axes[i].extent = 1;
+        strided_map_sum(src, dst, axes, f);
+        return;
+      }
+
+      ex.parallel_for(0, axes[k].extent,
+          [&] (int begin, int end)
+          {
+            std::array<strided_axis, N> chunk = axes;
+            chunk[k].extent = end - begin;
+            for(size_t i = n; i < N; ++i)
+              chunk[i].extent = 1;
+
+            strided_map_sum(src + begin * axes[k].src_stride,
+                dst + begin * axes[k].dst_stride, chunk, f);
+          });
+    }
+
+    /**
+     * @brief Edge length of the tiles of \ref strided_copy, a tile of
+     * doubles fits into the L1 cache
+     */
+    static const int strided_copy_tile = 32;
+
+    /**
+     * @brief Copy a strided table into a destination table of the same
+     * cells in a different layout, i.e. a tensor transpose
+     *
+     * No axis is summed over, every destination stride is non-zero. If the
+     * inner most axes of the source and the destination differ the copy
+     * runs over square tiles of these two axes, such that both the reads
+     * and the writes of a tile stay within a few cache lines.
+     */
+    template<typename Scalar, size_t N>
+    void strided_copy(const Scalar* src, Scalar* dst, std::array<strided_axis, N> axes)
+    {
+      size_t n = strided_plan(axes);
+
+      if(n == 0)
+      {
+        *dst = *src;
+        return;
+      }
+
+      // The source inner most axis is the last one, t is the destination
+      // inner most axis
+      size_t s = n - 1, t = n - 1;
+      for(size_t i = 0; i < n; ++i)
+        if(axes[i].dst_stride < axes[t].dst_stride)
+          t = i;
+
+      const strided_axis& a = axes[s];
+      const strided_axis& b = axes[t];
+      int tile = t == s ? 1 : strided_copy_tile;
+
+      std::array<int, N> counter;
+      counter.fill(0);
+      int src_offset = 0, dst_offset = 0;
+
+      while(true)
+      {
+        if(t == s)
+        {
+          for(int i = 0; i < a.extent; ++i)
+            dst[dst_offset + i * a.dst_stride] = src[src_offset + i * a.src_stride];
+        }
+        else
+        {
+          for(int j0 = 0; j0 < b.extent; j0 += tile)
+            for(int i0 = 0; i0 < a.extent; i0 += tile)
+            {
+              int j1 = std::min(j0 + tile, b.extent), i1 = std::min(i0 + tile, a.extent);
+              for(int j = j0; j < j1; ++j)
+                for(int i = i0; i < i1; ++i)
+                  dst[dst_offset + j * b.dst_stride + i * a.dst_stride] =
+                      src[src_offset + j * b.src_stride + i * a.src_stride];
+            }
+        }
+
+        // Odometer increment of the remaining axes
+        size_t k = s;
+        while(true)
+        {
+          if(k == 0)
+            return;
+          --k;
+          if(k == t)
+            continue;
+
+          src_offset += axes[k].src_stride;
+          dst_offset += axes[k].dst_stride;
+          if(++counter[k] < axes[k].extent)
+            break;
+
+          src_offset -= axes[k].src_stride * axes[k].extent;
+          dst_offset -= axes[k].dst_stride * axes[k].extent;
+          counter[k] = 0;
+        }
+      }
+    }
+
+    /**
+     * @brief strided_copy on an executor
+     *
+     * The outer most axis is split into chunks, different chunks write to
+     * disjoint cells of the destination.
+     */
+    template<typename Scalar, size_t N, typename Executor>
+    void strided_copy(const Scalar* src, Scalar* dst,
+        std::array<strided_axis, N> axes, const Executor& ex)
+    {
+      if(ex.concurrency() < 2)
+      {
+        strided_copy(src, dst, axes);
+        return;
+      }
+
+      size_t n = strided_plan(axes);
+      if(n == 0)
+      {
+        *dst = *src;
+        return;
+      }
+
+      for(size_t i = n; i < N; ++i)
+        axes[i].extent = 1;
+
+      ex.parallel_for(0, axes[0].extent,
+          [&] (int begin, int end)
+          {
+            std::array<strided_axis, N> chunk = axes;
+            chunk[0].extent = end - begin;
+
+            strided_copy(src + begin * axes[0].src_stride,
+                dst + begin * axes[0].dst_stride, chunk);
+          });
+    }
+
+    /** @cond PRIVATE */
+    template<typename Scalar, size_t N, typename F, typename Executor>
+    void accumulated_map_sum(const Scalar* src, Scalar* dst, int dst_size,
+        const std::array<strided_axis, N>& axes, F f, const Executor& ex,
+        std::true_type)
+    {
+      strided_map_sum(src, dst, axes, f, ex);
+    }
+
+    template<typename Scalar, size_t N, typename F, typename Executor>
+    void accumulated_map_sum(const Scalar* src, Scalar* dst, int dst_size,
+        const std::array<strided_axis, N>& axes, F f, const Executor& ex,
+        std::false_type)
+    {
+      typedef typename accumulator<Scalar>::type Acc;
+      typedef Eigen::Array<Scalar, Eigen::Dynamic, 1> array_type;
+      typedef Eigen::Array<Acc, Eigen::Dynamic, 1> acc_type;
+
+      acc_type acc = Eigen::Map<const array_type>(dst, dst_size).template cast<Acc>();
+      strided_map_sum(src, acc.data(), axes, f, ex);
+      Eigen::Map<array_type>(dst, dst_size) = acc.template cast<Scalar>();
+    }
+    /** @endcond */
+
+    /**
+     * @brief strided_map_sum that accumulates in \ref accumulator<Scalar>
+     *
+     * If the accumulator is wider than Scalar (see #PROB_MIXED_PRECISION)
+     * the destination table of dst_size cells is summed in a temporary
+     * buffer of the accumulator type and converted back afterwards.
+     */
+    template<typename Scalar, size_t N, typename F, typename Executor>
+    void accumulated_map_sum(const Scalar* src, Scalar* dst, int dst_size,
+        const std::array<strided_axis, N>& axes, F f, const Executor& ex)
+    {
+      accumulated_map_sum(src, dst, dst_size, axes, f, ex,
+          std::is_same<Scalar, typename accumulator<Scalar>::type>());
+    }
+  }
+}
+
+#endif /* _REDUCTION_H_ */
@@ -0,0 +1,335 @@
+#ifndef _SERIALIZATION_H_
+#define _SERIALIZATION_H_
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @file Serialization.hpp
+ *
+ * @brief Helpers of the binary distribution format
+ *
+ * A binary distribution file (see distribution::save_binary) consists of
+ *
+ * - the magic bytes "PROBDIST"
+ * - the byte order mark 0x01020304 (uint32), files are read on machines
+ *   of the same byte order only
+ * - the format version (uint32)
+ * - the scalar kind ('f' floating point, 'i' signed, 'u' unsigned integer)
+ *   and the size of the scalar in bytes (uint8 each)
+ * - 1 if the buffer is stored row major, 0 if column major (uint8) and one
+ *   reserved byte
+ * - the number of posterior and conditional variables (uint32 each)
+ * - for each posterior and then each conditional variable its label
+ *   (uint32 length followed by the characters) and its extent (int32)
+ * - the number of rows and columns of the backing matrix (uint64 each)
+ * - since version 2, zero bytes up to the next multiple of 64 bytes
+ * - the backing matrix as raw buffer in the stored layout
+ *
+ * Readers accept all versions up to their own \ref binary_format_version.
+ */
+
+namespace prob
+{
+  namespace core
+  {
+    /**
+     * @brief Version of the binary distribution format written by this library
+     *
+     * Version 2 pads the header such that the buffer is aligned for
+     * memory mapping (see \ref mapped_distribution).
+     */
+    static const std::uint32_t binary_format_version = 2;
+
+    /** @brief Byte order mark of the binary distribution format */
+    static const std::uint32_t binary_byte_order = 0x01020304;
+
+    /** @brief Magic bytes of the binary distribution format */
+    inline const char* binary_magic()
+    {
+      return "PROBDIST";
+    }
+
+    /** @brief Write the bytes of a trivially copyable value */
+    template<typename T>
+    void binary_write(std::ostream& out, const T& v)
+    {
+      out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+    }
+
+    /** @brief Read the bytes of a trivially copyable value */
+    template<typename T>
+    bool binary_read(std::istream& in, T& v)
+    {
+      return bool(in.read(reinterpret_cast<char*>(&v), sizeof(T)));
+    }
+
+    /** @brief Write a string prefixed by its length */
+    inline void binary_write_string(std::ostream& out, const std::string& s)
+    {
+      binary_write(out, std::uint32_t(s.size()));
+      out.write(s.data(), s.size());
+    }
+
+    /**
+     * @brief Read a string prefixed by its length
+     *
+     * The string is read in blocks, hence a corrupt length does not
+     * allocate more than the remaining stream holds.
+     */
+    inline bool binary_read_string(std::istream& in, std::string& s)
+    {
+      std::uint32_t length;
+      if(!binary_read(in, length))
+        return false;
+
+      s.clear();
+      char block[256];
+      while(s.size() < length)
+      {
+        std::size_t n = std::min<std::size_t>(sizeof(block), length - s.size());
+        if(!in.read(block, n))
+          return false;
+        s.append(block, n);
+      }
+      return true;
+    }
+
+    /** @brief Kind of a scalar type in the binary distribution format */
+    template<typename Scalar>
+    char binary_scalar_kind()
+    {
+      return std::is_floating_point<Scalar>::value ? 'f' :
+          (std::is_signed<Scalar>::value ? 'i' : 'u');
+    }
+
+    /** @cond PRIVATE */
+    template<typename T>
+    struct type_labels;
+
+    template<typename T>
+    struct extent_tuple;
+    /** @endcond */
+
+    /**
+     * @brief The labels of a list of random variable types
+     * declared with the #RVAR(x) macro (see \ref RVAR).
+     */
+    template<template<typename ...> class I, typename ...T>
+    struct type_labels<I<T...>>
+    {
+      static std::vector<std::string> labels()
+      {
+        return std::vector<std::string> { T::label()... };
+      }
+    };
+
+    /** @brief Builds a tuple of extents from an integer array */
+    template<typename ...E>
+    struct extent_tuple<std::tuple<E...>>
+    {
+      template<size_t... I>
+      static std::tuple<E...> build(const int* values,
+          util::compile_time_list::integer_list<I...>)
+      {
+        return std::tuple<E...>(E(values[I])...);
+      }
+
+      static std::tuple<E...> build(const int* values)
+      {
+        return build(values,
+            typename util::compile_time_list::iota_0<sizeof...(E)>::type());
+      }
+    };
+
+    /**
+     * @brief Header of the binary distribution format
+     */
+    struct binary_header
+    {
+      std::uint32_t version = binary_format_version;
+      char kind = 'f';
+      std::uint8_t scalar_size = 0;
+      std::uint8_t row_major = 0;
+      std::uint32_t posteriors = 0;
+      std::uint32_t conditionals = 0;
+      /** @brief Labels of the posterior and then the conditional variables */
+      std::vector<std::string> labels;
+      /** @brief Extents of the posterior and then the conditional variables */
+      std::vector<int> extents;
+      std::uint64_t rows = 0;
+      std::uint64_t cols = 0;
+
+      /**
+       * @brief Size of the header in bytes including the padding, i.e.
+       * the offset of the buffer within the file
+       */
+      std::size_t bytes() const
+      {
+        std::size_t n = unpadded_bytes();
+
+        // Since version 2 the buffer starts at a multiple of 64 bytes
+        if(version >= 2)
+          n = (n + 63) / 64 * 64;
+        return n;
+      }
+
+      /** @brief Size of the header fields without the padding */
+      std::size_t unpadded_bytes() const
+      {
+        std::size_t n = 8 + 4 + 4 + 4 + 4 + 4 + 8 + 8;
+        for(const std::string& l : labels)
+          n += 4 + l.size() + 4;
+        return n;
+      }
+
+      void write(std::ostream& out) const
+      {
+        out.write(binary_magic(), 8);
+        binary_write(out, binary_byte_order);
+        binary_write(out, version);
+        binary_write(out, kind);
+        binary_write(out, scalar_size);
+        binary_write(out, row_major);
+        binary_write(out, std::uint8_t(0));
+        binary_write(out, posteriors);
+        binary_write(out, conditionals);
+
+        for(std::size_t i = 0; i < labels.size(); ++i)
+        {
+          binary_write_string(out, labels[i]);
+          binary_write(out, std::int32_t(extents[i]));
+        }
+
+        binary_write(out, rows);
+        binary_write(out, cols);
+
+        for(std::size_t i = unpadded_bytes(); i < bytes(); ++i)
+          out.put(0);
+      }
+
+      /**
+       * @brief Read a header, the stream is left at the start of the buffer
+       *
+       * @param in The stream
+       * @param variables Number of variables of the distribution type that
+       * is read, headers with more variables are rejected before their
+       * labels are read
+       * @return false if the stream does not hold a header of a supported
+       * version
+       */
+      bool read(std::istream& in, std::size_t variables)
+      {
+        char magic[8];
+        if(!in.read(magic, 8) || std::string(magic, 8) != binary_magic())
+          return false;
+
+        std::uint32_t byte_order;
+        std::uint8_t reserved;
+        if(!binary_read(in, byte_order) || byte_order != binary_byte_order ||
+            !binary_read(in, version) || version == 0 ||
+            version > binary_format_version ||
+            !binary_read(in, kind) || !binary_read(in, scalar_size) ||
+            !binary_read(in, row_major) || !binary_read(in, reserved) ||
+            !binary_read(in, posteriors) || !binary_read(in, conditionals))
+          return false;
+
+        if(std::uint64_t(posteriors) + conditionals > variables)
+          return false;
+
+        labels.resize(posteriors + conditionals);
+        extents.resize(posteriors + conditionals);
+        for(std::size_t i = 0; i < labels.size(); ++i)
+        {
+          std::int32_t extent;
+          if(!binary_read_string(in, labels[i]) || !binary_read(in, extent) ||
+              extent <= 0)
+            return false;
+          extents[i] = extent;
+        }
+
+        if(!binary_read(in, rows) || !binary_read(in, cols))
+          return false;
+
+        return bool(in.ignore(bytes() - unpadded_bytes()));
+      }
+
+      /**
+       * @brief Does the header describe the posterior variables
+       * Posteriors and the conditional variables Conditionals (\ref vars)?
+       */
+      template<typename Posteriors, typename Conditionals>
+      bool matches() const
+      {
+        std::vector<std::string> expected = type_labels<Posteriors>::labels();
+        std::vector<std::string> conditional = type_labels<Conditionals>::labels();
+        expected.insert(expected.end(), conditional.begin(), conditional.end());
+
+        return posteriors == Posteriors::dim && conditionals == Conditionals::dim &&
+            labels == expected;
+      }
+
+      /**
+       * @brief Do the extents give the number of rows and columns?
+       *
+       * The products are taken in 64 bit and each axis has to fit an int,
+       * a crafted header must not wrap to the stored shape
+       */
+      bool consistent_extents() const
+      {
+        std::uint64_t cells[2] = {1, 1};
+        for(std::size_t i = 0; i < extents.size(); ++i)
+        {
+          std::uint64_t& n = cells[i < posteriors ? 0 : 1];
+          n *= std::uint64_t(extents[i]);
+          if(n > std::uint64_t(INT_MAX))
+            return false;
+        }
+        return cells[0] == cols && cells[1] == rows;
+      }
+    };
+
+    /**
+     * @brief Bulk read a raw matrix buffer of scalar type FileScalar and
+     * the given layout into a buffer of scalar type Scalar and layout
+     * RowMajor
+     */
+    template<typename FileScalar, bool RowMajor, typename Scalar>
+    bool binary_read_matrix(std::istream& in, Scalar* data, int rows, int cols,
+        bool file_row_major)
+    {
+      typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic,
+          RowMajor ? Eigen::RowMajor : Eigen::ColMajor> matrix_type;
+      typedef Eigen::Matrix<FileScalar, Eigen::Dynamic, Eigen::Dynamic,
+          Eigen::RowMajor> file_row_type;
+      typedef Eigen::Matrix<FileScalar, Eigen::Dynamic, Eigen::Dynamic,
+          Eigen::ColMajor> file_col_type;
+
+      std::streamsize bytes = std::streamsize(rows) * cols * sizeof(FileScalar);
+
+      // Same scalar and layout, read straight into the distribution
+      if(std::is_same<FileScalar, Scalar>::value && file_row_major == RowMajor)
+        return bool(in.read(reinterpret_cast<char*>(data), bytes));
+
+      std::vector<FileScalar> buffer(std::size_t(rows) * cols);
+      if(!in.read(reinterpret_cast<char*>(buffer.data()), bytes))
+        return false;
+
+      Eigen::Map<matrix_type> target(data, rows, cols);
+      if(file_row_major)
+        target = Eigen::Map<file_row_type>(buffer.data(), rows, cols).template cast<Scalar>();
+      else
+        target = Eigen::Map<file_col_type>(buffer.data(), rows, cols).template cast<Scalar>();
+
+      return true;
+    }
+  }
+}
+
+#endif /* _SERIALIZATION_H_ */
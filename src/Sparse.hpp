@@ -0,0 +1,498 @@
+#ifndef _SPARSE_H_
+#define _SPARSE_H_
+
+#include <cstdint>
+#include <unordered_map>
+
+/**
+ * @file Sparse.hpp
+ *
+ * @brief Discrete probability distributions that only store their
+ * nonzero probabilities
+ */
+
+namespace prob
+{
+  namespace core
+  {
+    /**
+     * @brief Calls a function with one random variable object per index
+     *
+     * The i-th argument of f is of the i-th type of the variable list and
+     * constructed from idx[i] (\ref given ignores its index).
+     */
+    template<typename V>
+    struct index_caller;
+
+    template<typename ...V, template<typename ...> class U>
+    struct index_caller<U<V...>>
+    {
+      template<typename F, size_t... I>
+      static void call(F& f, const int* idx,
+          util::compile_time_list::integer_list<I...>)
+      {
+        f(V(idx[I])...);
+      }
+
+      template<typename F>
+      static void call(F& f, const int* idx)
+      {
+        call(f, idx, typename util::compile_time_list::iota_0<sizeof...(V)>::type());
+      }
+    };
+  }
+
+  /**
+   * @brief A discrete probability distribution that only stores its
+   * nonzero probabilities
+   *
+   * The counterpart of \ref distribution for tables with a large index space
+   * of which only few events have a nonzero probability, e.g. the joint
+   * distribution of many variables collected from samples. The probabilities
+   * live in a hash map keyed by the position they would have in the backing
+   * matrix of the dense distribution (row * cols() + col), hence memory and
+   * the cost of all operations below scale with the number of nonzeros and
+   * not with the number of cells.
+   *
+   * Events are addressed like in \ref distribution:
+   *
+   * @code
+   * sparse_distribution<double, X, given, Y> pXgY(X(1000) | Y(1000));
+   * pXgY.prob_ref(X(3) | Y(7)) = 1.0;
+   * double p = pXgY(X(3) | Y(8)); // 0, nothing is inserted
+   * @endcode
+   *
+   * Reading with operator() never inserts, prob_ref does. Rows, columns,
+   * strides and keys are 64 bit integers, so the equivalent dense matrix may
+   * have more than 2^31 rows, columns or cells as long as the number of
+   * cells fits a std::int64_t; the extent of each single variable is an int.
+   *
+   * \ref join, \ref condition and the information theoretic functions
+   * \ref it::entropy, \ref it::conditional_entropy and
+   * \ref it::mutual_information are overloaded for sparse distributions.
+   * These run serially, the executor argument is accepted but ignored.
+   *
+   * @tparam Scalar The scalar type of the probabilities
+   * @tparam T... The type list of the random variable types (see \ref distribution)
+   */
+  template<typename Scalar, typename ...T>
+  class sparse_distribution
+  {
+  public:
+    /** @brief Position of an event in the dense matrix (row * cols() + col) */
+    typedef std::int64_t key_type;
+    /** @brief Storage of the nonzero probabilities */
+    typedef std::unordered_map<key_type, Scalar> storage_type;
+    /** @brief The dense distribution of the same variables */
+    typedef distribution<Scalar, T...> dense_type;
+    typedef Scalar scalar;
+
+    /** @brief See \ref distribution::row_type */
+    typedef typename core::splitter<T...>::conditional_type::index_type row_type;
+    /** @brief See \ref distribution::col_type */
+    typedef typename core::splitter<T...>::posterior_type::index_type col_type;
+    /** @brief See \ref distribution::row_strides_type */
+    typedef std::array<key_type, core::splitter<T...>::conditional_type::dim> row_strides_type;
+    /** @brief See \ref distribution::col_strides_type */
+    typedef std::array<key_type, core::splitter<T...>::posterior_type::dim> col_strides_type;
+
+    typedef typename core::splitter<T...>::conditional_type conditional_type;
+    typedef typename core::splitter<T...>::posterior_type posterior_type;
+    typedef typename core::splitter<T...>::expanded_type expanded_type;
+
+    /** @cond PRIVATE */
+    template<typename _T>
+    struct type_to_distribution;
+    /** @endcond */
+
+    /**
+     * @brief Variable type to sparse distribution type conversion
+     */
+    template<typename ..._T, template<typename ...> class U>
+    struct type_to_distribution<U<_T...>>
+    {
+      typedef sparse_distribution<Scalar, _T...> distribution_type;
+    };
+
+  private:
+    static constexpr size_t P = core::splitter<T...>::posteriors();
+    static constexpr size_t C = core::splitter<T...>::conditionals();
+
+    template <bool, bool, size_t, typename...> friend struct core::element_offset;
+
+    row_type _row_extents;
+    col_type _col_extents;
+
+    row_strides_type _row_strides;
+    col_strides_type _col_strides;
+
+    key_type _rows;
+    key_type _cols;
+
+    storage_type _values;
+
+    void update_strides()
+    {
+      _rows = core::stride_builder<0, C>::build(_row_extents, _row_strides);
+      _cols = core::stride_builder<0, P>::build(_col_extents, _col_strides);
+    }
+
+    /** @brief Row and column of an element given as packed arguments */
+    template<typename... _T>
+    key_type element_key(const _T&... t) const
+    {
+      typedef core::splitter<typename std::decay<_T>::type...> local_splitter;
+
+      static_assert(util::traits::are_equivalent<
+          typename local_splitter::expanded_type, T...>::value,
+          "Random variable type mismatch");
+
+      key_type row = 0, col = 0;
+      core::element_offset<false, false, 0,
+          typename std::decay<_T>::type...>::accumulate(*this, row, col, t...);
+      return key(row, col);
+    }
+
+  public:
+    /**
+     * @brief Constructor for distributions of statically sized random variables
+     */
+    sparse_distribution() :
+        _row_extents(core::static_row_extents<T...>::extents()),
+        _col_extents(core::static_col_extents<T...>::extents())
+    {
+      update_strides();
+    }
+
+    /**
+     * @brief Constructor for distributions with dynamically sized random variables
+     *
+     * @code
+     * sparse_distribution<double, X, given, Y> p(X(10) | Y(5));
+     * @endcode
+     */
+    template<typename... _T>
+    sparse_distribution(_T... t) :
+        _row_extents(core::splitter<_T...>::row_index(std::forward<_T>(t)...)),
+        _col_extents(core::splitter<_T...>::col_index(std::forward<_T>(t)...))
+    {
+      typedef core::splitter<typename std::decay<_T>::type...> local_splitter;
+
+      extents_assert<T...>::assert_static();
+
+      static_assert(util::traits::are_equivalent<typename local_splitter::expanded_type, T...>::value,
+          "Random variable type mismatch");
+
+      update_strides();
+    }
+
+    /** @brief An empty distribution with the given extents */
+    sparse_distribution(const row_type& row_extents, const col_type& col_extents) :
+        _row_extents(row_extents),
+        _col_extents(col_extents)
+    {
+      update_strides();
+    }
+
+    /** @brief Copy of the nonzero probabilities of a dense distribution */
+    explicit sparse_distribution(const dense_type& dense) :
+        _row_extents(dense.row_extents()),
+        _col_extents(dense.col_extents())
+    {
+      update_strides();
+
+      for(int col = 0; col < dense.cols(); ++col)
+        for(int row = 0; row < dense.rows(); ++row)
+          if(dense.coeff(row, col) != Scalar(0))
+            _values[key(row, col)] = dense.coeff(row, col);
+    }
+
+    /**
+     * @brief Is the distribution a conditional distribution?
+     */
+    static constexpr bool conditional_distribution()
+    {
+      return core::splitter<T...>::conditional_distribution;
+    }
+
+    /** @brief Number of rows of the equivalent dense matrix */
+    key_type rows() const { return _rows; }
+    /** @brief Number of columns of the equivalent dense matrix */
+    key_type cols() const { return _cols; }
+    /** @brief Number of cells of the equivalent dense matrix */
+    key_type size() const { return _rows * _cols; }
+    /** @brief Number of stored probabilities */
+    size_t nonZeros() const { return _values.size(); }
+
+    /** @brief Key of the matrix coordinates (row, col) */
+    key_type key(key_type row, key_type col) const { return row * _cols + col; }
+    /** @brief Row of a key */
+    key_type row(key_type k) const { return k / _cols; }
+    /** @brief Column of a key */
+    key_type col(key_type k) const { return k % _cols; }
+
+    /** @brief Extents of the conditional variables as a tuple */
+    row_type row_extents() const { return _row_extents; }
+    /** @brief Extents of the posterior variables as a tuple */
+    col_type col_extents() const { return _col_extents; }
+    /** @brief Strides of the conditional variables */
+    const row_strides_type& row_strides() const { return _row_strides; }
+    /** @brief Strides of the posterior variables */
+    const col_strides_type& col_strides() const { return _col_strides; }
+
+    /** @brief The stored probabilities keyed by \ref key */
+    const storage_type& storage() const { return _values; }
+    /** @brief The stored probabilities keyed by \ref key */
+    storage_type& storage() { return _values; }
+
+    /** @brief Reserve storage for n nonzeros */
+    void reserve(size_t n) { _values.reserve(n); }
+
+    /** @brief Remove all probabilities */
+    void setZero() { _values.clear(); }
+
+    /**
+     * @brief Read a probability, Scalar(0) if it is not stored
+     */
+    template<typename... _T>
+    Scalar operator()(_T... t) const
+    {
+      auto it = _values.find(element_key(t...));
+      return it == _values.end() ? Scalar(0) : it->second;
+    }
+
+    /** @brief Read the probability of a key, Scalar(0) if it is not stored */
+    Scalar at(key_type k) const
+    {
+      auto it = _values.find(k);
+      return it == _values.end() ? Scalar(0) : it->second;
+    }
+
+    /**
+     * @brief Get a probability reference, inserts a zero if the event is
+     * not stored yet
+     */
+    template<typename... _T>
+    Scalar& prob_ref(_T... t)
+    {
+      return _values[element_key(t...)];
+    }
+
+    /** @brief Drop all stored probabilities not larger than epsilon */
+    void prune(Scalar epsilon = Scalar(0))
+    {
+      for(auto it = _values.begin(); it != _values.end();)
+        if(it->second <= epsilon)
+          it = _values.erase(it);
+        else
+          ++it;
+    }
+
+    /**
+     * @brief Index of each variable of the event stored at key k
+     *
+     * Posterior indices first, then the conditional indices (without a
+     * slot for \ref given), i.e. numbered like the group indices of
+     * \ref marginalize.
+     */
+    void indices(key_type k, std::array<int, P + C>& idx) const
+    {
+      std::array<int, P> col_extents = core::extent_array(_col_extents);
+      std::array<int, C> row_extents = core::extent_array(_row_extents);
+
+      key_type r = row(k), c = col(k);
+      for(size_t i = 0; i < P; ++i)
+        idx[i] = int((c / _col_strides[i]) % col_extents[i]);
+      for(size_t i = 0; i < C; ++i)
+        idx[P + i] = int((r / _row_strides[i]) % row_extents[i]);
+    }
+
+    /**
+     * @brief Iterate over the stored events
+     *
+     * Calls f(t...) (with the expanded variable types T...) once for every
+     * stored probability, in no particular order.
+     */
+    template<typename F>
+    void each_index(F f) const
+    {
+      static constexpr size_t E = expanded_type::dim;
+
+      std::array<int, P + C> idx;
+      std::array<int, E> args;
+      args.fill(0);
+
+      for(const auto& e : _values)
+      {
+        indices(e.first, idx);
+        for(size_t i = 0; i < P; ++i)
+          args[i] = idx[i];
+        for(size_t i = 0; i < C; ++i)
+          args[E - C + i] = idx[P + i];
+
+        core::index_caller<expanded_type>::call(f, args.data());
+      }
+    }
+
+    /** @brief Sum of all probabilities */
+    Scalar sum() const
+    {
+      Scalar s(0);
+      for(const auto& e : _values)
+        s += e.second;
+      return s;
+    }
+
+    /**
+     * @brief Normalize each posterior distribution
+     *
+     * Rows without any stored probability stay empty.
+     */
+    void normalize()
+    {
+      std::unordered_map<key_type, Scalar> sums;
+      for(const auto& e : _values)
+        sums[row(e.first)] += e.second;
+
+      for(auto& e : _values)
+        e.second /= sums[row(e.first)];
+    }
+
+    /**
+     * @brief Sparse marginalization
+     *
+     * Same semantics as \ref distribution::marginalize, runs over the stored
+     * probabilities only.
+     */
+    template<int... GroupIndices>
+    auto marginalize() const ->
+    typename type_to_distribution<
+    typename core::indexed_type_selector<expanded_type, P, C, -1,
+    GroupIndices...>::result_type>::distribution_type
+    {
+      static_assert(core::check_indices<P, C, 0, GroupIndices...>::valid(),
+          "Variable index out of range");
+
+      typedef typename type_to_distribution<
+          typename core::indexed_type_selector<expanded_type, P, C, -1,
+          GroupIndices...>::result_type>::distribution_type result_type;
+
+      result_type grouped_dist(
+          util::tuple::subset(_row_extents, typename core::index_splitter<
+              row_type, P, C, GroupIndices...>::row_index_type()),
+          util::tuple::subset(_col_extents, typename core::index_splitter<
+              col_type, P, C, GroupIndices...>::col_index_type()));
+
+      const int group_indices[] = { GroupIndices... };
+      const size_t groups = sizeof...(GroupIndices);
+
+      // Posterior group indices always precede conditional group indices
+      std::array<int, P + C> idx;
+      for(const auto& e : _values)
+      {
+        indices(e.first, idx);
+
+        key_type grouped_row = 0, grouped_col = 0;
+        size_t grouped_posteriors = 0;
+        for(size_t k = 0; k < groups; ++k)
+        {
+          size_t g = group_indices[k];
+          if(g < P)
+          {
+            grouped_col += idx[g] * grouped_dist.col_strides()[k];
+            ++grouped_posteriors;
+          }
+          else
+          {
+            grouped_row += idx[g] * grouped_dist.row_strides()[k - grouped_posteriors];
+          }
+        }
+
+        grouped_dist.storage()[grouped_dist.key(grouped_row, grouped_col)] += e.second;
+      }
+
+      return grouped_dist;
+    }
+
+    /** @brief The equivalent dense distribution */
+    dense_type to_dense() const
+    {
+      dense_type dense(dense_type::matrix_type::Zero(_rows, _cols),
+          _row_extents, _col_extents);
+
+      for(const auto& e : _values)
+        dense.coeffRef(int(row(e.first)), int(col(e.first))) = e.second;
+
+      return dense;
+    }
+  };
+
+  namespace core
+  {
+    /** @cond PRIVATE */
+
+    template<typename Scalar, typename ...A, typename ...B>
+    struct join_impl<sparse_distribution<Scalar, A...>, sparse_distribution<Scalar, B...>>
+    {
+      typedef sparse_distribution<Scalar, A..., B...> return_type;
+
+      template<typename Executor>
+      static return_type join(const sparse_distribution<Scalar, A...>& distA,
+          const sparse_distribution<Scalar, B...>& distB, const Executor&)
+      {
+        return_type result(std::make_tuple<>(),
+            util::tuple::concat(distA.col_extents(),distB.col_extents()));
+        result.reserve(distA.nonZeros() * distB.nonZeros());
+
+        // The variables of B are the inner most, the column of (a, b)
+        // is a*|B|+b
+        typedef typename return_type::key_type key_type;
+        key_type colsB = distB.cols();
+        for(const auto& a : distA.storage())
+          for(const auto& b : distB.storage())
+            result.storage()[distA.col(a.first) * colsB +
+                             distB.col(b.first)] = a.second * b.second;
+
+        return result;
+      }
+    };
+
+    template<template<typename ...> class V,
+    typename Scalar, typename ...A, typename ...B, typename ...AB>
+    struct condition_impl<V<A...>, V<B...>, Scalar,
+        sparse_distribution<Scalar, AB...>, sparse_distribution<Scalar, B...>>
+    {
+      typedef sparse_distribution<Scalar, A..., given, B...> return_type;
+
+      template<typename Executor>
+      static void condition(const sparse_distribution<Scalar, AB...>& distAB,
+          const sparse_distribution<Scalar, B...>& distB,
+          return_type& distAgB, const Executor&)
+      {
+        auto col_extents = util::tuple::subset(
+            distAB.col_extents(),
+            typename util::compile_time_list::iota_0<sizeof...(A)>::type());
+
+        distAgB = return_type(distB.col_extents(), col_extents);
+        distAgB.reserve(distAB.nonZeros());
+
+        // The column a*|B|+b of AB becomes the cell (b, a) of AgB,
+        // events with p(b...) = 0 are left out
+        typedef typename return_type::key_type key_type;
+        key_type colsB = distB.cols();
+        for(const auto& e : distAB.storage())
+        {
+          key_type a = distAB.col(e.first) / colsB;
+          key_type b = distAB.col(e.first) % colsB;
+          Scalar pB = distB.at(b);
+          if(pB > Scalar(0))
+            distAgB.storage()[distAgB.key(b, a)] = e.second / pB;
+        }
+      }
+    };
+
+    /** @endcond */
+  }
+}
+
+#endif /* _SPARSE_H_ */
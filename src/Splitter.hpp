@@ -45,6 +45,57 @@ namespace prob
     struct index_splitter;
     /** @endcond */
 
+    /**
+     * @brief Compile time extent of a single random variable type
+     *
+     * Evaluates to the extent of staticly sized random variables and
+     * to Eigen::Dynamic for dynamically sized ones. The \ref given dummy
+     * does not contribute to the size.
+     */
+    template<typename H>
+    struct static_extent
+    {
+      static const int value = H::static_rvar() ? H::extent() : Eigen::Dynamic;
+    };
+
+    template<>
+    struct static_extent<given>
+    {
+      static const int value = 1;
+    };
+
+    /**
+     * @brief Product of two compile time sizes
+     *
+     * Results in Eigen::Dynamic if any of the two is dynamic or if the
+     * product exceeds #PROB_MAX_FIXED_SIZE.
+     */
+    template<int A, int B>
+    struct static_size_product
+    {
+      static const int value =
+          (A == Eigen::Dynamic || B == Eigen::Dynamic ||
+              (B > 0 && A > PROB_MAX_FIXED_SIZE / B)) ?
+          Eigen::Dynamic : A * B;
+    };
+
+    /**
+     * @brief Sizes of the backing matrix given the row and column sizes
+     *
+     * Keeps fixed sizes as long as the whole matrix stays within
+     * #PROB_MAX_FIXED_SIZE, otherwise both dimensions become dynamic.
+     */
+    template<int Rows, int Cols>
+    struct storage_size
+    {
+      static const bool too_big =
+          static_size_product<Rows, Cols>::value == Eigen::Dynamic &&
+          Rows != Eigen::Dynamic && Cols != Eigen::Dynamic;
+
+      static const int rows = too_big ? Eigen::Dynamic : Rows;
+      static const int cols = too_big ? Eigen::Dynamic : Cols;
+    };
+
     /** @brief Dimensionality type */
     template<>
     struct vars<>
@@ -56,12 +107,19 @@ namespace prob
 
     };
 
-    /** @brief Dimensionality type */
+    /**
+     * @brief Dimensionality type
+     *
+     * The eigen_size is the product of all extents if all variables
+     * are staticly sized, Eigen::Dynamic otherwise.
+     */
     template<typename H, typename ... P>
     struct vars<H, P...>
     {
       static const size_t dim = 1 + vars<P...>::dim;
-      static const int eigen_size = Eigen::Dynamic;
+      static const int eigen_size =
+          static_size_product<static_extent<H>::value,
+          vars<P...>::eigen_size>::value;
 
       typedef typename util::traits::join<std::tuple, std::tuple<H>,
           typename vars<P...>::index_type>::type index_type;
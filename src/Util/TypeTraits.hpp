@@ -168,6 +168,84 @@ namespace prob
       {
         typedef HeadT type;
       };
+
+      /** @cond PRIVATE */
+      template<typename T, typename ...U>
+      struct type_index;
+      /** @endcond */
+
+      /**
+       * @brief Position of the first occurrence of T in the type list U...,
+       * -1 if T is not contained
+       */
+      template<typename T>
+      struct type_index<T>
+      {
+        static const int value = -1;
+      };
+
+      /**
+       * @brief Position of the first occurrence of T in the type list U...,
+       * -1 if T is not contained
+       */
+      template<typename T, typename ...U>
+      struct type_index<T, T, U...>
+      {
+        static const int value = 0;
+      };
+
+      /**
+       * @brief Position of the first occurrence of T in the type list U...,
+       * -1 if T is not contained
+       */
+      template<typename T, typename H, typename ...U>
+      struct type_index<T, H, U...>
+      {
+        static const int value = type_index<T, U...>::value < 0 ?
+            -1 : type_index<T, U...>::value + 1;
+      };
+
+      /**
+       * @brief Whether the types of a type list are pairwise distinct
+       */
+      template<typename ...T>
+      struct are_distinct
+      {
+        static const bool value = true;
+      };
+
+      /**
+       * @brief Whether the types of a type list are pairwise distinct
+       */
+      template<typename H, typename ...T>
+      struct are_distinct<H, T...>
+      {
+        static const bool value = type_index<H, T...>::value < 0 &&
+            are_distinct<T...>::value;
+      };
+      /** @cond PRIVATE */
+      template<typename L, typename ...T>
+      struct contains_all;
+      /** @endcond */
+
+      /**
+       * @brief Whether all types of the packed list L are in the type list T...
+       */
+      template<template<typename ...> class L, typename ...T>
+      struct contains_all<L<>, T...>
+      {
+        static const bool value = true;
+      };
+
+      /**
+       * @brief Whether all types of the packed list L are in the type list T...
+       */
+      template<template<typename ...> class L, typename H, typename ...A, typename ...T>
+      struct contains_all<L<H, A...>, T...>
+      {
+        static const bool value = type_index<H, T...>::value >= 0 &&
+            contains_all<L<A...>, T...>::value;
+      };
     }
   }
 }
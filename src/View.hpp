@@ -0,0 +1,158 @@
+#ifndef _VIEW_H_
+#define _VIEW_H_
+
+/**
+ * @file View.hpp
+ *
+ * @brief Read only views of the posterior distributions of a conditional
+ * distribution
+ */
+
+namespace prob
+{
+  /**
+   * @brief A read only view of a posterior distribution @f$ p(\cdot | y...) @f$
+   *
+   * The backing matrix is an Eigen::Map over the row of the conditional
+   * distribution (with the stride between its columns), nothing is copied.
+   * Views are obtained by \ref distribution::posterior_view and
+   * \ref distribution::each_posterior and are only valid as long as the
+   * conditional distribution is alive and not reshaped.
+   *
+   * @code
+   * pXgY.each_conditional_index([&] (const Y& y)
+   *     {
+   *       posterior_view<double, X> pXgy = pXgY.posterior_view(y);
+   *       double h = it::entropy(pXgy);
+   *     });
+   * @endcode
+   *
+   * Element access, each_index, marginalize (\ref distribution::grouped_map_sum),
+   * entropy and kl_divergence work as on \ref distribution, marginals
+   * are returned as (owning) distributions.
+   */
+  template<typename Scalar, typename ...T>
+  class posterior_view : public Eigen::Map<const typename distribution<Scalar, T...>::matrix_type,
+    Eigen::Unaligned, Eigen::InnerStride<>>
+  {
+  public:
+    typedef distribution<Scalar, T...> dense_type;
+    typedef typename dense_type::matrix_type matrix_type;
+    typedef Eigen::Map<const matrix_type, Eigen::Unaligned, Eigen::InnerStride<>> map_type;
+    typedef Scalar scalar;
+
+    typedef typename dense_type::row_type row_type;
+    typedef typename dense_type::col_type col_type;
+    typedef typename dense_type::row_strides_type row_strides_type;
+    typedef typename dense_type::col_strides_type col_strides_type;
+    typedef typename dense_type::conditional_type conditional_type;
+    typedef typename dense_type::posterior_type posterior_type;
+    typedef typename dense_type::expanded_type expanded_type;
+
+    static_assert(!dense_type::conditional_distribution(),
+        "A posterior view has no conditional variables");
+
+    /**
+     * @brief Variable type to distribution type conversion
+     *
+     * Results of marginalizations are owning distributions.
+     */
+    template<typename _T>
+    struct type_to_distribution : dense_type::template type_to_distribution<_T>
+    {
+    };
+
+  private:
+    template <bool> friend struct core::conditional_case;
+    template <bool, bool, size_t, typename...> friend struct core::element_offset;
+    core::conditional_case<false> cased;
+
+    row_type _row_extents;
+    col_type _col_extents;
+
+    row_strides_type _row_strides;
+    col_strides_type _col_strides;
+
+  public:
+    /**
+     * @brief View of cols values starting at data that are stride
+     * scalars apart
+     */
+    posterior_view(const Scalar* data, int cols, int stride,
+        const col_type& col_extents, const col_strides_type& col_strides) :
+        map_type(data, 1, cols, Eigen::InnerStride<>(stride)),
+        _col_extents(col_extents),
+        _col_strides(col_strides)
+    {
+    }
+
+    /** @brief See \ref distribution::conditional_distribution */
+    static constexpr bool conditional_distribution()
+    {
+      return false;
+    }
+
+    /** @brief Extents of the conditional variables as a tuple */
+    row_type row_extents() const { return _row_extents; }
+    /** @brief Extents of the posterior variables as a tuple */
+    col_type col_extents() const { return _col_extents; }
+    /** @brief Strides of the conditional variables */
+    const row_strides_type& row_strides() const { return _row_strides; }
+    /** @brief Strides of the posterior variables */
+    const col_strides_type& col_strides() const { return _col_strides; }
+
+    /** @brief Read a probability value, see \ref distribution::operator() */
+    template<typename... _T>
+    Scalar operator()(_T... t) const
+    {
+      static_assert(util::traits::are_equivalent<
+          expanded_type, typename std::decay<_T>::type...>::value,
+          "Random variable type mismatch");
+
+      int row = 0, col = 0;
+      core::element_offset<false, false, 0,
+          typename std::decay<_T>::type...>::accumulate(*this, row, col, t...);
+
+      return map_type::coeff(col);
+    }
+
+    /** @brief See \ref distribution::each_index */
+    template<typename F>
+    void each_index(F f) const
+    {
+      cased.each_index(*this, f);
+    }
+
+    /** @brief See \ref distribution::each_index */
+    template<typename F, typename Executor>
+    void each_index(F f, const Executor& ex) const
+    {
+      cased.each_index(*this, f, ex);
+    }
+
+    /** @brief See \ref distribution::grouped_map_sum */
+    template<int... GroupIndices, typename F, typename Executor = serial_executor>
+    auto grouped_map_sum(F f, const Executor& ex = Executor()) const  ->
+    typename core::grouped_map_sum_impl<posterior_view, GroupIndices...>::result_type
+    {
+      return core::grouped_map_sum_impl<posterior_view, GroupIndices...>::apply(
+          *this, f, ex);
+    }
+
+    /** @brief See \ref distribution::marginalize */
+    template<int... GroupIndices, typename Executor = serial_executor>
+    auto marginalize(const Executor& ex = Executor()) const ->
+    typename core::grouped_map_sum_impl<posterior_view, GroupIndices...>::result_type
+    {
+      return grouped_map_sum<GroupIndices...>(core::identity_functor(), ex);
+    }
+
+    /** @brief Copy into an owning distribution */
+    dense_type to_distribution() const
+    {
+      return dense_type(matrix_type(*this), _row_extents, _col_extents);
+    }
+  };
+}
+
+#endif /* _VIEW_H_ */
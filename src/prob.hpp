@@ -25,6 +25,16 @@
  */
 #define PROB_EPSILON 1e-15
 
+#ifndef PROB_MAX_FIXED_SIZE
+/**
+ * @brief Maximal number of cells of a distribution over staticly sized
+ * random variables that is backed by a fixed size Eigen matrix
+ *
+ * Larger distributions fall back to dynamically allocated storage.
+ */
+#define PROB_MAX_FIXED_SIZE 1024
+#endif
+
 #include "Util/MakeIndices.hpp"
 #include "Util/TupleFunctions.hpp"
 #include "Util/TypeTraits.hpp"
@@ -32,11 +42,26 @@
 
 #include "RandomVariable.hpp"
 #include "Splitter.hpp"
+#include "Precision.hpp"
+#include "LogSpace.hpp"
+#include "Parallel.hpp"
+#include "Reduction.hpp"
+#include "Serialization.hpp"
 #include "Distribution.hpp"
+#include "View.hpp"
+#include "Batch.hpp"
+#include "Mapped.hpp"
+#include "Counts.hpp"
 
 #include "Algebra.hpp"
+#include "Contraction.hpp"
+#include "Inference.hpp"
+#include "Sparse.hpp"
 #include "Initializers.hpp"
 #include "InformationTheory.hpp"
+#include "InformationTheory/Batch.hpp"
+#include "InformationTheory/Sparse.hpp"
+#include "InformationTheory/Online.hpp"
 #include "InformationTheory/Decomposition.hpp"
 
 #endif /* _PROB_H_ */
@@ -21,6 +21,7 @@ protected:
   prob::distribution<double,A, B, C, prob::given, D> pABCgD;
   prob::distribution<double, A, prob::given, B, C,D> pAgBCD, qAgBCD;
   prob::distribution<double, B, C, prob::given, D> pBCgD;
+  prob::distribution<double, A, prob::given, D> pAgD, qAgD;
 };
 
 TEST_F(Algebra, JoinMarginalize)
@@ -36,6 +37,23 @@ TEST_F(Algebra, JoinMarginalize)
   EXPECT_LT((pBC-qBC).array().abs().sum(),1e-10);
 }
 
+TEST_F(Algebra, JoinConditionals)
+{
+  prob::init::random(pAgD, gen);
+  prob::init::random(pBCgD, gen);
+
+  pABCgD = prob::join_conditionals(pAgD, pBCgD);
+
+  pABCgD.each_index([&] (const A& a, const B& b, const C& c, prob::given g, const D& d)
+      {
+        EXPECT_LT(abs(pABCgD(a,b,c|d) - pAgD(a|d)*pBCgD(b,c|d)), 1e-15);
+      });
+
+  qAgD = pABCgD.marginalize<0,3>();
+
+  EXPECT_LT((pAgD-qAgD).array().abs().sum(), 1e-10);
+}
+
 TEST_F(Algebra, UnconditionCondition)
 {
     prob::init::random(pAgBC, gen);
@@ -71,3 +89,57 @@ TEST_F(Algebra, Bayes)
   EXPECT_LT((qAgBC-pAgBC).array().abs().sum(), 1e-10);
 }
 
+
+TEST_F(Algebra, ThreadPool)
+{
+  prob::thread_pool pool(4);
+
+  prob::init::random(pAgBC, gen);
+  prob::init::random(pBC, gen);
+
+  pABC = prob::uncondition(pAgBC, pBC, pool);
+  qABC = prob::uncondition(pAgBC, pBC);
+  EXPECT_EQ(pABC, qABC);
+
+  auto pA = pABC.marginalize<0>(pool);
+  EXPECT_LT((pA - pABC.marginalize<0>()).array().abs().sum(), 1e-12);
+
+  prob::condition(pABC, pBC, qAgBC, pool);
+  EXPECT_LT((qAgBC-pAgBC).array().abs().sum(), 1e-10);
+
+  pBCgA = prob::bayes(pAgBC, pA, pBC, pool);
+  EXPECT_EQ(pBCgA, prob::bayes(pAgBC, pA, pBC));
+
+  EXPECT_EQ(prob::join(pA, pBC, pool), prob::join(pA, pBC));
+
+  EXPECT_LT(std::abs(prob::it::mutual_information(pAgBC, pBC, pool) -
+      prob::it::mutual_information(pAgBC, pBC)), 1e-12);
+  EXPECT_LT(std::abs(prob::it::entropy(pABC, pool) - prob::it::entropy(pABC)), 1e-12);
+}
+
+TEST_F(Algebra, Lazy)
+{
+  prob::thread_pool pool(4);
+
+  prob::init::random(pAgBC, gen);
+  prob::init::random(pA, gen);
+  prob::init::random(pBC, gen);
+
+  pABC = prob::uncondition(pAgBC, pBC);
+  auto uABC = prob::lazy::uncondition(pAgBC, pBC);
+  qABC = uABC;
+  EXPECT_EQ(pABC, qABC);
+
+  EXPECT_LT((uABC.marginalize<0>() - pABC.marginalize<0>()).array().abs().sum(), 1e-12);
+  EXPECT_LT((uABC.marginalize<0, 2>() - pABC.marginalize<0, 2>()).array().abs().sum(), 1e-12);
+  EXPECT_LT((uABC.marginalize<2, 1>() - pABC.marginalize<2, 1>()).array().abs().sum(), 1e-12);
+  EXPECT_LT((uABC.marginalize<1, 2>(pool) - pBC).array().abs().sum(), 1e-12);
+  EXPECT_LT((prob::marginalize(uABC, prob::util::compile_time_list::integer_list<0, 1>()) -
+      pABC.marginalize<0, 1>()).array().abs().sum(), 1e-12);
+
+  auto jABC = prob::lazy::join(pA, pBC);
+  pABC = prob::join(pA, pBC);
+  EXPECT_EQ(pABC, jABC.eval());
+  EXPECT_LT((jABC.marginalize<0>() - pA).array().abs().sum(), 1e-12);
+  EXPECT_LT((jABC.marginalize<0, 2>(pool) - pABC.marginalize<0, 2>()).array().abs().sum(), 1e-12);
+}
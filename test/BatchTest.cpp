@@ -0,0 +1,79 @@
+#include "gtest/gtest.h"
+#include "TestVariables.hpp"
+
+class Batch : public ::testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    gen = std::mt19937(rd());
+  }
+
+  std::random_device rd;
+  std::mt19937 gen;
+
+  const int members = 37;
+};
+
+TEST_F(Batch, SetGet)
+{
+  prob::distribution<double, X, prob::given, Y> pXgY(X(3)|Y(4));
+  prob::distribution_batch<double, X, prob::given, Y> batch(members, pXgY);
+
+  EXPECT_EQ(batch.size(), members);
+  EXPECT_EQ(batch.cells(), 12);
+
+  for(int k = 0; k < members; ++k)
+  {
+    prob::init::random(pXgY, gen);
+    batch.set(k, pXgY);
+  }
+
+  EXPECT_EQ(batch.get(members - 1), pXgY);
+
+  pXgY.each_index([&] (const X& x, prob::given g, const Y& y)
+      {
+        int cell = batch.cell(prob::read_index<Y>::read(y), prob::read_index<X>::read(x));
+        EXPECT_EQ(batch.values(cell)(members - 1), pXgY(x|y));
+      });
+}
+
+TEST_F(Batch, InformationTheory)
+{
+  prob::distribution<double, A, prob::given, C> pAgC;
+  prob::distribution<double, C> pC;
+  prob::distribution<double, A, C> pAC;
+
+  prob::distribution_batch<double, A, prob::given, C> bAgC(members, pAgC);
+  prob::distribution_batch<double, C> bC(members, pC);
+  prob::distribution_batch<double, A, C> bAC(members, pAC), bQ(members, pAC);
+
+  for(int k = 0; k < members; ++k)
+  {
+    prob::init::random(pAgC, gen);
+    prob::init::random(pC, gen);
+    bAgC.set(k, pAgC);
+    bC.set(k, pC);
+    bAC.set(k, prob::uncondition(pAgC, pC));
+    prob::init::random(pAC, gen);
+    bQ.set(k, pAC);
+  }
+
+  prob::thread_pool pool(3);
+
+  Eigen::ArrayXd h = prob::it::batch::entropy(bAC, pool);
+  Eigen::ArrayXd hc = prob::it::batch::conditional_entropy(bAgC, bC);
+  Eigen::ArrayXd mi = prob::it::batch::mutual_information(bAgC, bC, pool);
+  Eigen::ArrayXd kl = prob::it::batch::kl_divergence(bAC, bQ);
+  Eigen::ArrayXd mi_approx =
+      prob::it::batch::mutual_information<prob::it::approximate_log>(bAgC, bC);
+
+  for(int k = 0; k < members; ++k)
+  {
+    EXPECT_LT(std::abs(h(k) - prob::it::entropy(bAC.get(k))), 1e-12);
+    EXPECT_LT(std::abs(hc(k) - prob::it::conditional_entropy(bAgC.get(k), bC.get(k))), 1e-12);
+    EXPECT_LT(std::abs(mi(k) - prob::it::mutual_information(bAgC.get(k), bC.get(k))), 1e-12);
+    EXPECT_LT(std::abs(kl(k) - prob::it::kl_divergence(bAC.get(k), bQ.get(k))), 1e-12);
+    EXPECT_LT(std::abs(mi_approx(k) - mi(k)), 1e-8);
+  }
+}
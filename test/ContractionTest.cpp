@@ -0,0 +1,114 @@
+#include "gtest/gtest.h"
+#include "TestVariables.hpp"
+
+class Contraction : public ::testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    gen = std::mt19937(rd());
+  }
+
+  std::random_device rd;
+  std::mt19937 gen;
+
+  prob::distribution<double, A, prob::given, B> pAgB;
+  prob::distribution<double, B> pB;
+  prob::distribution<double, A, prob::given, C> pAgC;
+  prob::distribution<double, B, prob::given, C> pBgC;
+  prob::distribution<double, A, prob::given, B, C> pAgBC;
+  prob::distribution<double, A, B, prob::given, C> pABgC;
+  prob::distribution<double, D, prob::given, B, C> pDgBC;
+  prob::distribution<double, D, prob::given, B> pDgB;
+};
+
+TEST_F(Contraction, MarkovChain)
+{
+  prob::distribution<double, X, prob::given, Y> pXgY(X(4)|Y(50));
+  prob::distribution<double, Y, prob::given, Z> pYgZ(Y(50)|Z(3));
+  prob::init::random(pXgY, gen);
+  prob::init::random(pYgZ, gen);
+
+  prob::distribution<double, X, prob::given, Z> pXgZ = prob::contract<X, Z>(pXgY, pYgZ);
+
+  pXgZ.each_index([&] (const X& x, prob::given g, const Z& z)
+      {
+        double p = 0;
+        for(int y = 0; y < 50; ++y)
+          p += pXgY(x|Y(y)) * pYgZ(Y(y)|z);
+        EXPECT_NEAR(pXgZ(x|z), p, 1e-12);
+      });
+
+  EXPECT_LT((pXgZ.sum_by_conditional().array() - 1).abs().maxCoeff(), 1e-12);
+}
+
+TEST_F(Contraction, Algebra)
+{
+  prob::init::random(pAgB, gen);
+  prob::init::random(pB, gen);
+  prob::init::random(pAgC, gen);
+  prob::init::random(pBgC, gen);
+  prob::init::random(pAgBC, gen);
+
+  auto pAB = prob::contract<A, B>(pAgB, pB);
+  EXPECT_LT((pAB - prob::uncondition(pAgB, pB)).array().abs().sum(), 1e-12);
+
+  auto pA = prob::contract<A>(pAgB, pB);
+  EXPECT_LT((pA - pAB.marginalize<0>()).array().abs().sum(), 1e-12);
+
+  auto pBA = prob::contract<B, A>(pAgB, pB);
+  EXPECT_LT((pBA - pAB.marginalize<1, 0>()).array().abs().sum(), 1e-12);
+
+  auto pABgC = prob::contract<A, B, C>(pAgC, pBgC);
+  EXPECT_LT((pABgC - prob::join_conditionals(pAgC, pBgC)).array().abs().sum(), 1e-12);
+
+  auto qABgC = prob::contract<A, B, C>(pAgBC, pBgC);
+  EXPECT_LT((qABgC - prob::partial_uncondition(pAgBC, pBgC)).array().abs().sum(), 1e-12);
+}
+
+TEST_F(Contraction, Batched)
+{
+  prob::init::random(pABgC, gen);
+  prob::init::random(pDgBC, gen);
+  prob::init::random(pDgB, gen);
+
+  // C is a batch, B is summed by the products
+  prob::distribution<double, D, A, prob::given, C> pDAgC = prob::contract<D, A, C>(pABgC, pDgBC);
+
+  pDAgC.each_index([&] (const D& d, const A& a, prob::given g, const C& c)
+      {
+        double p = 0;
+        for(int b = 0; b < B::extent(); ++b)
+          p += pABgC(a, B(b)|c) * pDgBC(d|B(b), c);
+        EXPECT_NEAR(pDAgC(d, a|c), p, 1e-12);
+      });
+
+  // C is only a variable of the first factor and summed beforehand
+  prob::distribution<double, A, D> pAD = prob::contract<A, D>(pABgC, pDgB);
+
+  pAD.each_index([&] (const A& a, const D& d)
+      {
+        double p = 0;
+        for(int b = 0; b < B::extent(); ++b)
+          for(int c = 0; c < C::extent(); ++c)
+            p += pABgC(a, B(b)|C(c)) * pDgB(d|B(b));
+        EXPECT_NEAR(pAD(a, d), p, 1e-12);
+      });
+
+  prob::thread_pool pool(4);
+  EXPECT_LT((prob::contract<D, A, C>(pABgC, pDgBC, pool) - pDAgC).array().abs().sum(), 1e-12);
+  EXPECT_LT((prob::contract<A, D>(pABgC, pDgB, pool) - pAD).array().abs().sum(), 1e-12);
+}
+
+TEST_F(Contraction, LogSpace)
+{
+  typedef prob::logspace<double> lp;
+
+  prob::init::random(pABgC, gen);
+  prob::init::random(pDgBC, gen);
+
+  auto pDAgC = prob::contract<D, A, C>(pABgC, pDgBC);
+  auto lDAgC = prob::contract<D, A, C>(pABgC.scalar_cast<lp>(), pDgBC.scalar_cast<lp>());
+
+  EXPECT_LT((pDAgC - lDAgC.scalar_cast<double>()).array().abs().sum(), 1e-12);
+}
@@ -0,0 +1,98 @@
+#include "gtest/gtest.h"
+#include "TestVariables.hpp"
+
+class Counts : public ::testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    gen = std::mt19937(rd());
+
+    std::uniform_int_distribution<int> x(0, 3), y(0, 2);
+    for(int k = 0; k < samples; ++k)
+    {
+      xs.push_back(x(gen));
+      ys.push_back(y(gen));
+      xys.push_back(xs.back());
+      xys.push_back(ys.back());
+    }
+  }
+
+  std::random_device rd;
+  std::mt19937 gen;
+
+  const int samples = 1000;
+  std::vector<int> xs, ys, xys;
+};
+
+TEST_F(Counts, Accumulate)
+{
+  prob::counts<X, prob::given, Y> tuples(X(4)|Y(3)), rows(X(4)|Y(3)),
+      columns(X(4)|Y(3));
+
+  for(int k = 0; k < samples; ++k)
+    tuples.add(X(xs[k])|Y(ys[k]));
+
+  rows.add_samples(xys.data(), samples);
+  columns.add_columns({{ xs.data(), ys.data() }}, samples);
+
+  EXPECT_EQ(tuples.total(), samples);
+  EXPECT_EQ(rows.values(), tuples.values());
+  EXPECT_EQ(columns.values(), tuples.values());
+
+  prob::distribution<double, X, prob::given, Y> pXgY = tuples.release();
+  for(int y = 0; y < 3; ++y)
+    EXPECT_LT(std::abs(pXgY.row(y).sum() - 1), 1e-12);
+
+  int n = 0;
+  for(int k = 0; k < samples; ++k)
+    n += (xs[k] == 1 && ys[k] == 2);
+  EXPECT_DOUBLE_EQ(pXgY(X(1)|Y(2)) * columns.values().row(2).sum(), n);
+}
+
+TEST_F(Counts, Merge)
+{
+  prob::counts<X, Y> all(X(4), Y(3)), first(X(4), Y(3)), second(X(4), Y(3));
+
+  all.add_samples(xys.data(), samples);
+  first.add_samples(xys.data(), samples / 2);
+  second.add_samples(xys.data() + 2 * (samples / 2), samples - samples / 2);
+  first += second;
+  EXPECT_EQ(first.values(), all.values());
+
+  prob::counts<X, Y> parallel(X(4), Y(3));
+  prob::thread_pool pool(3);
+  parallel.add_samples(xys.data(), samples, pool);
+  EXPECT_EQ(parallel.values(), all.values());
+}
+
+TEST_F(Counts, OnlineInformation)
+{
+  const int window = 300;
+  prob::it::online_information<X, prob::given, Y> online(X(4)|Y(3));
+
+  for(int k = 0; k < samples; ++k)
+  {
+    online.add(&xys[2 * k]);
+    if(k >= window)
+      online.remove(&xys[2 * (k - window)]);
+  }
+
+  prob::counts<X, Y> last(X(4), Y(3));
+  last.add_samples(&xys[2 * (samples - window)], window);
+  auto pXY = last.release();
+
+  double hXY = prob::it::entropy(pXY);
+  double hX = prob::it::entropy(pXY.marginalize<0>());
+  double hY = prob::it::entropy(pXY.marginalize<1>());
+
+  EXPECT_EQ(online.total(), window);
+  EXPECT_LT(std::abs(online.joint_entropy() - hXY), 1e-9);
+  EXPECT_LT(std::abs(online.posterior_entropy() - hX), 1e-9);
+  EXPECT_LT(std::abs(online.conditional_entropy() - (hXY - hY)), 1e-9);
+  EXPECT_LT(std::abs(online.mutual_information() - (hX + hY - hXY)), 1e-9);
+
+  double mi = online.mutual_information();
+  online.recompute();
+  EXPECT_LT(std::abs(online.mutual_information() - mi), 1e-9);
+}
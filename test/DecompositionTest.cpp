@@ -0,0 +1,188 @@
+#include "gtest/gtest.h"
+#include "prob"
+
+// Built with PROB_EXPERIMENTAL (see CMakeLists.txt)
+
+RVAR_STATIC(X,2)
+RVAR_STATIC(Y,2)
+RVAR_STATIC(Z,5)
+
+class Decomposition : public ::testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    gen = std::mt19937(rd());
+
+    // Skewed, uniform random values give nearly independent variables
+    prob::init::random(pXYZ, gen);
+    pXYZ.array() = pXYZ.array().pow(4);
+    pXYZ.normalize();
+
+    pX = pXYZ.marginalize<0>();
+    pY = pXYZ.marginalize<1>();
+    pZ = pXYZ.marginalize<2>();
+
+    prob::condition(pXYZ.marginalize<2,0>(), pX, pZgX);
+    prob::condition(pXYZ.marginalize<2,1>(), pY, pZgY);
+    prob::condition(pXYZ.marginalize<0,2>(), pZ, pXgZ);
+    prob::condition(pXYZ.marginalize<1,2>(), pZ, pYgZ);
+    prob::condition(pXYZ, pZ, pXYgZ);
+  }
+
+  /**
+   * I^pi_Z(A \searrow B) with the projection of each p(z|a) found by a
+   * ternary search on the segment between the two rows of p(z|b), along
+   * which the Kullback-Leibler divergence is convex
+   */
+  template<typename A, typename B>
+  double reference_projection(const prob::distribution<double,Z,prob::given,A>& pZgA,
+      const prob::distribution<double,A>& pA,
+      const prob::distribution<double,Z,prob::given,B>& pZgB)
+  {
+    double info = 0;
+    pA.each_index([&] (const A& a)
+        {
+          auto q = [&] (double w, const Z& z)
+              {
+                return w * pZgB(z|B(0)) + (1 - w) * pZgB(z|B(1));
+              };
+
+          auto divergence = [&] (double w)
+              {
+                double d = 0;
+                pZ.each_index([&] (const Z& z)
+                    {
+                      d += pZgA(z|a) * std::log(pZgA(z|a) / q(w, z));
+                    });
+                return d;
+              };
+
+          double lo = 0, hi = 1;
+          for(int i = 0; i < 200; ++i)
+          {
+            double m1 = lo + (hi - lo) / 3, m2 = hi - (hi - lo) / 3;
+            if(divergence(m1) < divergence(m2))
+              hi = m2;
+            else
+              lo = m1;
+          }
+
+          double w = (lo + hi) / 2;
+          pZ.each_index([&] (const Z& z)
+              {
+                info += pA(a) * pZgA(z|a) * std::log2(q(w, z) / pZ(z));
+              });
+        });
+    return info;
+  }
+
+  std::random_device rd;
+  std::mt19937 gen;
+
+  prob::distribution<double,X,Y,Z> pXYZ;
+  prob::distribution<double,X> pX;
+  prob::distribution<double,Y> pY;
+  prob::distribution<double,Z> pZ;
+
+  prob::distribution<double,Z,prob::given,X> pZgX;
+  prob::distribution<double,Z,prob::given,Y> pZgY;
+  prob::distribution<double,X,prob::given,Z> pXgZ;
+  prob::distribution<double,Y,prob::given,Z> pYgZ;
+  prob::distribution<double,X,Y,prob::given,Z> pXYgZ;
+};
+
+TEST_F(Decomposition, MinimalInformation)
+{
+  // Specific information I(Z=z;A) of each event, the smaller one counts
+  double expected = 0;
+  pZ.each_index([&] (const Z& z)
+      {
+        double x_info = 0, y_info = 0;
+        pX.each_index([&] (const X& x)
+            {
+              if(pXgZ(x|z) > 0)
+                x_info += pXgZ(x|z) * std::log2(pXgZ(x|z) / pX(x));
+            });
+        pY.each_index([&] (const Y& y)
+            {
+              if(pYgZ(y|z) > 0)
+                y_info += pYgZ(y|z) * std::log2(pYgZ(y|z) / pY(y));
+            });
+        expected += pZ(z) * std::min(x_info, y_info);
+      });
+
+  // log_of_2<double> is rounded to 9 digits
+  EXPECT_NEAR(prob::it::decomp::minimal_information(pXgZ, pYgZ, pZ), expected, 1e-9);
+}
+
+TEST_F(Decomposition, Executor)
+{
+  prob::thread_pool pool(4);
+
+  EXPECT_NEAR(prob::it::decomp::minimal_information(pXgZ, pYgZ, pZ, pool),
+      prob::it::decomp::minimal_information(pXgZ, pYgZ, pZ), 1e-12);
+  EXPECT_NEAR(prob::it::decomp::redundancy(pZgX, pZgY, pX, pY, pZ, pool),
+      prob::it::decomp::redundancy(pZgX, pZgY, pX, pY, pZ), 1e-12);
+}
+
+TEST_F(Decomposition, Redundancy)
+{
+  double expected = std::min(reference_projection(pZgX, pX, pZgY),
+      reference_projection(pZgY, pY, pZgX));
+
+  // The projection stops within 1e-5 nats of the minimal divergence
+  EXPECT_NEAR(prob::it::decomp::redundancy(pZgX, pZgY, pX, pY, pZ), expected, 2e-5);
+}
+
+TEST_F(Decomposition, IcmObjective)
+{
+  typedef prob::distribution<double,Z,prob::given,Z> DistZgZ;
+  typedef prob::it::decomp::core::icm_workspace<decltype(pXYgZ), decltype(pZ),
+      DistZgZ, decltype(pXgZ), decltype(pYgZ), 1, 1> workspace_type;
+
+  workspace_type workspace(pXYgZ, pZ);
+  std::vector<double> grad;
+
+  // A random channel p(z'|z), given row by row in z
+  std::uniform_real_distribution<> unit_interval(0, 1);
+  std::vector<double> channel(25);
+  for(int z = 0; z < 5; ++z)
+  {
+    double sum = 0;
+    for(int n = 0; n < 5; ++n)
+      sum += channel[z * 5 + n] = unit_interval(gen);
+    for(int n = 0; n < 5; ++n)
+      channel[z * 5 + n] /= sum;
+  }
+
+  // p(x,y,z') = sum_z p(z'|z)p(z)p(x,y|z)
+  prob::distribution<double,X,Y,prob::given,Z> pXYgZn;
+  prob::distribution<double,Z> pZn;
+  pXYgZn.setZero();
+  pZn.setZero();
+  pXYgZ.each_index([&] (const X& x, const Y& y, prob::given g, const Z& z)
+      {
+        for(int n = 0; n < 5; ++n)
+        {
+          double p = channel[prob::read_index<Z>::read(z) * 5 + n] * pZ(z) * pXYgZ(x, y|z);
+          pXYgZn(x, y|Z(n)) += p;
+          pZn(Z(n)) += p;
+        }
+      });
+  pXYgZn.normalize();
+
+  auto pXgZn = pXYgZn.marginalize<0,2>();
+  auto pYgZn = pXYgZn.marginalize<1,2>();
+
+  EXPECT_NEAR(prob::it::decomp::core::icm_objective<workspace_type>(channel, grad, &workspace),
+      prob::it::conditional_mutual_information(pXYgZn, pXgZn, pYgZn, pZn), 1e-12);
+
+  // The identity channel leaves I(X;Y|Z)
+  std::vector<double> identity(25, 0.0);
+  for(int z = 0; z < 5; ++z)
+    identity[z * 5 + z] = 1;
+
+  EXPECT_NEAR(prob::it::decomp::core::icm_objective<workspace_type>(identity, grad, &workspace),
+      prob::it::conditional_mutual_information(pXYgZ, pXgZ, pYgZ, pZ), 1e-12);
+}
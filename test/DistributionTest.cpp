@@ -1,6 +1,8 @@
 #include "gtest/gtest.h"
 #include "TestVariables.hpp"
 
+#include <mutex>
+
 class Distribution : public ::testing::Test {
  protected:
   virtual void SetUp()
@@ -176,6 +178,51 @@ TEST_F(Distribution, PosteriorAccess)
               prob::read_index<C>::read(c) * prob::read_index<D>::read(d));
 }
 
+TEST_F(Distribution, PosteriorView)
+{
+  pABgCD.setRandom();
+  pABgCD.map([] (double p) { return std::abs(p) + 0.1; });
+  pABgCD.normalize();
+
+  for(C c = 0; c < C::extent();c++)
+    for(D d = 0; d < D::extent();d++)
+    {
+      prob::posterior_view<double,A,B> vAB = pABgCD.posterior_view(c,d);
+      prob::distribution<double,A,B> pAB = pABgCD.posterior_distribution(c,d);
+
+      vAB.each_index([&] (const A& a, const B& b)
+          {
+            EXPECT_EQ(vAB(a,b), pAB(a,b));
+          });
+
+      EXPECT_EQ(vAB.to_distribution(), pAB);
+      EXPECT_EQ(vAB.marginalize<1>(), pAB.marginalize<1>());
+      EXPECT_NEAR(prob::it::entropy(vAB), prob::it::entropy(pAB), 1e-12);
+      EXPECT_NEAR(prob::it::kl_divergence(vAB, pABgCD.posterior_view(C(0),D(0))),
+          prob::it::kl_divergence(pAB, pABgCD.posterior_distribution(C(0),D(0))), 1e-12);
+    }
+
+  // Posteriors are visited in the order of the conditional indices
+  int row = 0;
+  pABgCD.each_posterior([&] (const prob::posterior_view<double,A,B>& vAB)
+      {
+        EXPECT_EQ(vAB, pABgCD.row(row));
+        row++;
+      });
+  EXPECT_EQ(row, C::extent() * D::extent());
+
+  prob::thread_pool pool(3);
+  Eigen::VectorXd entropies(pABgCD.rows());
+  pABgCD.each_posterior([&] (const prob::posterior_view<double,A,B>& vAB)
+      {
+        entropies(&vAB.coeff(0) - pABgCD.data()) = prob::it::entropy(vAB);
+      }, pool);
+
+  for(int i = 0; i < pABgCD.rows(); ++i)
+    EXPECT_NEAR(entropies(i), prob::it::entropy(
+        prob::distribution<double,A,B>(pABgCD.row(i), std::make_tuple<>(), pAB.col_extents())), 1e-12);
+}
+
 
 TEST_F(Distribution, NormalizationAndSum)
 {
@@ -248,6 +295,75 @@ TEST_F(Distribution, Map)
 }
 
 
+TEST_F(Distribution, ParallelEachIndex)
+{
+  prob::distribution<double,A,B, prob::given, C,D> qABgCD;
+
+  qABgCD.parallel_each_index([&] (const A& a, const B& b, prob::given g, const C& c, const D& d)
+      {
+        qABgCD.prob_ref(a,b,g,c,d) = pABgCD(a,b|c,d);
+      }, 4);
+
+  EXPECT_EQ(qABgCD, pABgCD);
+
+  prob::distribution<double,X,Y> pXY(X(9),Y(4));
+  int visited = 0;
+  std::mutex m;
+
+  pXY.parallel_each_index([&] (const X& x, const Y& y)
+      {
+        pXY.prob_ref(x,y) = prob::read_index<X>::read(x) * 4 + prob::read_index<Y>::read(y);
+        std::lock_guard<std::mutex> lock(m);
+        visited++;
+      }, 4);
+
+  EXPECT_EQ(visited, 36);
+  for(int i = 0; i < 36; ++i)
+    EXPECT_EQ(pXY(X(i/4),Y(i%4)), i);
+
+  qABgCD.parallel_map([] (double p) { return p*p; }, 3);
+  pABgCD.map([] (double p) { return p*p; });
+  EXPECT_EQ(qABgCD, pABgCD);
+
+  qABgCD.parallel_normalize(3);
+  pABgCD.normalize();
+  EXPECT_EQ(qABgCD, pABgCD);
+}
+
+
+TEST_F(Distribution, EachIndexOffset)
+{
+  int visited = 0;
+  pABgCD.each_index_offset([&] (int offset, const A& a, const B& b, prob::given g, const C& c, const D& d)
+      {
+        EXPECT_EQ(pABgCD.data()[offset], pABgCD(a,b|c,d));
+        visited++;
+      });
+  EXPECT_EQ(visited, pABgCD.size());
+
+  pAB.each_index_offset([&] (int offset, const A& a, const B& b)
+      {
+        EXPECT_EQ(pAB.data()[offset], pAB(a,b));
+      });
+
+  // Writes through the offset on an executor
+  prob::distribution<double,X,prob::given,Y,Z> pXgYZ(X(10)|Y(5),Z(7));
+  double* values = pXgYZ.data();
+  prob::thread_pool pool(4);
+  pXgYZ.each_index_offset([&] (int offset, const X& x, prob::given g, const Y& y, const Z& z)
+      {
+        values[offset] = prob::read_index<X>::read(x) * 35 +
+            prob::read_index<Y>::read(y) * 7 + prob::read_index<Z>::read(z);
+      }, pool);
+
+  pXgYZ.each_index([&] (const X& x, prob::given g, const Y& y, const Z& z)
+      {
+        EXPECT_EQ(pXgYZ(x|y,z), prob::read_index<X>::read(x) * 35 +
+            prob::read_index<Y>::read(y) * 7 + prob::read_index<Z>::read(z));
+      });
+}
+
+
 TEST_F(Distribution, MapConditional)
 {
   pABgCD.setConstant(1.0);
@@ -312,6 +428,59 @@ TEST_F(Distribution, GroupedMapSum)
 
 }
 
+TEST_F(Distribution, GroupedMapSumStrided)
+{
+  prob::distribution<double,X,Y,Z,prob::given,W> pXYZgW(X(3),Y(4),Z(5)|W(6));
+
+  std::mt19937 gen(42);
+  prob::init::random(pXYZgW, gen);
+
+  auto pZXgW = pXYZgW.marginalize<2,0,3>();
+
+  pZXgW.each_index([&] (const Z& z, const X& x, prob::given g, const W& w)
+  {
+    double sum = 0;
+    for(Y y = 0; y < 4; y++)
+      sum += pXYZgW(x,y,z|w);
+    EXPECT_LT(abs(pZXgW(z,x|w)-sum), 1e-12);
+  });
+
+  auto sYgW = pXYZgW.grouped_map_sum<1,3>([] (double p) { return p*p; });
+
+  sYgW.each_index([&] (const Y& y, prob::given g, const W& w)
+  {
+    double sum = 0;
+    for(X x = 0; x < 3; x++)
+      for(Z z = 0; z < 5; z++)
+        sum += pXYZgW(x,y,z|w) * pXYZgW(x,y,z|w);
+    EXPECT_LT(abs(sYgW(y|w)-sum), 1e-12);
+  });
+}
+
+TEST_F(Distribution, Permute)
+{
+  prob::distribution<double,X,Y,prob::given,Z> pXYgZ(X(37),Y(50)|Z(3));
+
+  std::mt19937 gen(42);
+  prob::init::random(pXYgZ, gen);
+
+  auto pYXgZ = pXYgZ.permute<Y,X,prob::given,Z>();
+  auto tYZgX = pXYgZ.permute<Y,Z,prob::given,X>();
+
+  pXYgZ.each_index([&] (const X& x, const Y& y, prob::given g, const Z& z)
+  {
+    EXPECT_EQ(pYXgZ(y,x|z), pXYgZ(x,y|z));
+    EXPECT_EQ(tYZgX(y,z|x), pXYgZ(x,y|z));
+  });
+
+  // A marginalization keeping all variables is a permutation
+  EXPECT_EQ((pXYgZ.marginalize<1,0,2>() - pYXgZ).array().abs().maxCoeff(), 0);
+
+  prob::thread_pool pool(3);
+  EXPECT_EQ((pXYgZ.permute<Y,Z,prob::given,X>(pool) - tYZgX).array().abs().maxCoeff(), 0);
+  EXPECT_EQ((tYZgX.permute<X,Y,prob::given,Z>() - pXYgZ).array().abs().maxCoeff(), 0);
+}
+
 // Output / Input
 TEST_F(Distribution, InputOutput)
 {
@@ -366,4 +535,52 @@ X Y | Z W\n\
   EXPECT_EQ(qXYgZW, pXYgZW);
 }
 
+TEST_F(Distribution, BinaryInputOutput)
+{
+  prob::distribution<double,X,Y,prob::given,Z> pXYgZ(X(3),Y(4)|Z(5));
+  pXYgZ.setRandom();
+
+  std::stringstream s;
+  pXYgZ.save_binary(s);
+
+  auto qXYgZ = prob::distribution<double,X,Y,prob::given,Z>::load_binary(s);
+  EXPECT_TRUE(bool(s));
+  EXPECT_EQ(qXYgZ, pXYgZ);
+
+  // Converted to another scalar type
+  s.seekg(0);
+  auto fXYgZ = prob::distribution<float,X,Y,prob::given,Z>::load_binary(s);
+  EXPECT_TRUE(bool(s));
+  EXPECT_LT((fXYgZ.cast<double>() - pXYgZ).array().abs().maxCoeff(), 1e-6);
+
+  // Static random variables
+  std::stringstream t;
+  pABgCD.save_binary(t);
+  EXPECT_EQ((prob::distribution<double,A,B,prob::given,C,D>::load_binary(t)), pABgCD);
+
+  // Random variables that do not match the file
+  s.seekg(0);
+  prob::distribution<double,X,Z,prob::given,Y>::load_binary(s);
+  EXPECT_FALSE(bool(s));
+}
+
+TEST_F(Distribution, BinaryCraftedExtents)
+{
+  prob::distribution<double,X,Y> pXY(X(1),Y(65536));
+  pXY.setZero();
+
+  std::stringstream s;
+  pXY.save_binary(s);
+  prob::core::binary_header header;
+  ASSERT_TRUE(header.read(s, 2));
+
+  // 65537 * 65536 wraps around to the stored 65536 columns in int
+  std::string bytes = s.str();
+  std::int32_t extent = 65537;
+  bytes.replace(28 + 4 + header.labels[0].size(), 4, reinterpret_cast<const char*>(&extent), 4);
+  std::stringstream t(bytes);
+  prob::distribution<double,X,Y>::load_binary(t);
+  EXPECT_FALSE(bool(t));
+}
+
 
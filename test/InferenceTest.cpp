@@ -0,0 +1,121 @@
+#include "gtest/gtest.h"
+#include "TestVariables.hpp"
+
+RVAR_STATIC(V0, 10)
+RVAR_STATIC(V1, 10)
+RVAR_STATIC(V2, 10)
+RVAR_STATIC(V3, 10)
+RVAR_STATIC(V4, 10)
+RVAR_STATIC(V5, 10)
+RVAR_STATIC(V6, 10)
+RVAR_STATIC(V7, 10)
+
+class Inference : public ::testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    gen = std::mt19937(rd());
+
+    prob::init::random(pA, gen);
+    prob::init::random(pBgA, gen);
+    prob::init::random(pCgB, gen);
+    prob::init::random(pDgBC, gen);
+
+    network.add(pA);
+    network.add(pBgA);
+    network.add(pCgB);
+    network.add(pDgBC);
+
+    pABCD.each_index([&] (const A& a, const B& b, const C& c, const D& d)
+        {
+          pABCD.prob_ref(a, b, c, d) = pA(a) * pBgA(b|a) * pCgB(c|b) * pDgBC(d|b, c);
+        });
+  }
+
+  std::random_device rd;
+  std::mt19937 gen;
+
+  prob::distribution<double, A> pA;
+  prob::distribution<double, B, prob::given, A> pBgA;
+  prob::distribution<double, C, prob::given, B> pCgB;
+  prob::distribution<double, D, prob::given, B, C> pDgBC;
+  prob::distribution<double, A, B, C, D> pABCD;
+
+  prob::factor_graph<double> network;
+};
+
+TEST_F(Inference, Marginals)
+{
+  EXPECT_EQ(network.factors(), 4);
+  EXPECT_EQ(network.variables(), 4);
+
+  EXPECT_LT((network.marginal<D>() - pABCD.marginalize<3>()).array().abs().sum(), 1e-12);
+  EXPECT_LT((network.marginal<A, D>() - pABCD.marginalize<0, 3>()).array().abs().sum(), 1e-12);
+  EXPECT_LT((network.marginal<C, A>() - pABCD.marginalize<2, 0>()).array().abs().sum(), 1e-12);
+  EXPECT_LT((network.marginal<B, C, D>() - pABCD.marginalize<1, 2, 3>()).array().abs().sum(), 1e-12);
+  EXPECT_LT((network.marginal<A>() - pA).array().abs().sum(), 1e-12);
+
+  prob::thread_pool pool(4);
+  EXPECT_LT((network.marginal<C, A>(pool) - pABCD.marginalize<2, 0>()).array().abs().sum(), 1e-12);
+
+  EXPECT_THROW(network.marginal<E>(), std::invalid_argument);
+  EXPECT_THROW((network.marginal<A, E>()), std::invalid_argument);
+
+  prob::factor_graph<double> mismatched;
+  mismatched.add(prob::distribution<double, X>(X(3)));
+  EXPECT_THROW(mismatched.add(prob::distribution<double, Y, prob::given, X>(Y(2)|X(4))),
+      std::invalid_argument);
+  EXPECT_EQ(mismatched.variables(), 1);
+}
+
+TEST_F(Inference, EliminationOrder)
+{
+  // All descendants of A are summed to one without being multiplied
+  EXPECT_TRUE(network.elimination_order<A>().empty());
+
+  EXPECT_EQ(network.elimination_order<B>(), std::vector<std::string>({ "A" }));
+  EXPECT_EQ(network.elimination_order<D>().size(), 3);
+}
+
+TEST_F(Inference, MarkovChain)
+{
+  // The joint distribution has 10^8 cells, the eliminations 10^2
+  prob::distribution<double, V0> p0;
+  prob::distribution<double, V1, prob::given, V0> p1g0;
+  prob::distribution<double, V2, prob::given, V1> p2g1;
+  prob::distribution<double, V3, prob::given, V2> p3g2;
+  prob::distribution<double, V4, prob::given, V3> p4g3;
+  prob::distribution<double, V5, prob::given, V4> p5g4;
+  prob::distribution<double, V6, prob::given, V5> p6g5;
+  prob::distribution<double, V7, prob::given, V6> p7g6;
+
+  prob::init::random(p0, gen);
+  prob::init::random(p1g0, gen);
+  prob::init::random(p2g1, gen);
+  prob::init::random(p3g2, gen);
+  prob::init::random(p4g3, gen);
+  prob::init::random(p5g4, gen);
+  prob::init::random(p6g5, gen);
+  prob::init::random(p7g6, gen);
+
+  prob::factor_graph<double> chain;
+  chain.add(p7g6);
+  chain.add(p3g2);
+  chain.add(p0);
+  chain.add(p5g4);
+  chain.add(p1g0);
+  chain.add(p6g5);
+  chain.add(p2g1);
+  chain.add(p4g3);
+
+  auto p7g0 = prob::contract<V7, V0>(p7g6, prob::contract<V6, V0>(p6g5,
+      prob::contract<V5, V0>(p5g4, prob::contract<V4, V0>(p4g3,
+          prob::contract<V3, V0>(p3g2, prob::contract<V2, V0>(p2g1, p1g0))))));
+  auto p7 = prob::contract<V7>(p7g0, p0);
+  auto p07 = prob::contract<V0, V7>(p7g0, p0);
+
+  EXPECT_LT((chain.marginal<V7>() - p7).array().abs().sum(), 1e-12);
+  EXPECT_LT((chain.marginal<V0, V7>() - p07).array().abs().sum(), 1e-12);
+  EXPECT_NEAR(chain.marginal<V4>().sum(), 1, 1e-12);
+}
@@ -75,6 +75,19 @@ TEST_F(Information, MutualInformation)
   EXPECT_LT(abs(prob::it::mutual_information(pXgY, pY) - 0.375), 1e-10);
 }
 
+TEST_F(Information, ApproximateLog)
+{
+  for(double x = 1e-12; x < 1e3; x *= 1.37)
+    EXPECT_LT(std::abs(prob::it::fast_log(x) - std::log(x)), 1e-9 * std::max(1.0, std::abs(std::log(x))));
+
+  EXPECT_LT(std::abs(prob::it::entropy<prob::it::approximate_log>(pXY) -
+      prob::it::entropy(pXY)), 1e-8);
+  EXPECT_LT(std::abs(prob::it::conditional_entropy<prob::it::approximate_log>(pYgX, pX) -
+      prob::it::conditional_entropy(pYgX, pX)), 1e-8);
+  EXPECT_LT(std::abs(prob::it::mutual_information<prob::it::approximate_log>(pXgY, pY) -
+      prob::it::mutual_information(pXgY, pY)), 1e-8);
+}
+
 TEST_F(Information, KullbackLeiblerDivergence)
 {
   EXPECT_LT(abs(prob::it::kl_divergence(p, q) - 0.2075), 1e-10);
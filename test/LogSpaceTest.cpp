@@ -0,0 +1,118 @@
+#include "gtest/gtest.h"
+#include "TestVariables.hpp"
+
+typedef prob::logspace<double> lp;
+
+class LogSpace : public ::testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    gen = std::mt19937(rd());
+  }
+
+  // Distance of a distribution and its log-space counterpart
+  template<typename Dist, typename LDist>
+  double difference(const Dist& p, const LDist& l)
+  {
+    return (p - l.template scalar_cast<double>()).array().abs().sum();
+  }
+
+  std::random_device rd;
+  std::mt19937 gen;
+};
+
+TEST_F(LogSpace, Scalar)
+{
+  lp a(0.25), b(0.5);
+
+  EXPECT_NEAR((a + b).value(), 0.75, 1e-15);
+  EXPECT_NEAR((b - a).value(), 0.25, 1e-15);
+  EXPECT_NEAR((a * b).value(), 0.125, 1e-15);
+  EXPECT_NEAR((a / b).value(), 0.5, 1e-15);
+  EXPECT_TRUE(a < b);
+  EXPECT_TRUE(a > 0.1);
+  EXPECT_EQ(lp(0) + a, a);
+  EXPECT_EQ(lp(0).value(), 0);
+
+  lp tiny(1e-200);
+  EXPECT_NEAR((tiny * tiny * tiny).log(), 3 * std::log(1e-200), 1e-9);
+  EXPECT_NEAR((tiny * tiny + tiny * tiny).log(), std::log(2) + 2 * std::log(1e-200), 1e-9);
+}
+
+TEST_F(LogSpace, Algebra)
+{
+  prob::distribution<double, A, prob::given, B, C> pAgBC;
+  prob::distribution<double, B, C> pBC;
+  prob::init::random(pAgBC, gen);
+  prob::init::random(pBC, gen);
+
+  auto lAgBC = pAgBC.scalar_cast<lp>();
+  auto lBC = pBC.scalar_cast<lp>();
+
+  auto pABC = prob::uncondition(pAgBC, pBC);
+  auto lABC = prob::uncondition(lAgBC, lBC);
+  EXPECT_LT(difference(pABC, lABC), 1e-12);
+
+  EXPECT_LT(difference(pABC.marginalize<0>(), lABC.marginalize<0>()), 1e-12);
+  EXPECT_LT(difference(pABC.marginalize<0, 2>(), lABC.marginalize<0, 2>()), 1e-12);
+  EXPECT_LT(difference(pABC.marginalize<1, 2>(), lABC.marginalize<1, 2>()), 1e-12);
+
+  prob::distribution<lp, A, prob::given, B, C> qAgBC;
+  prob::condition(lABC, lBC, qAgBC);
+  EXPECT_LT(difference(pAgBC, qAgBC), 1e-12);
+
+  auto lA = lABC.marginalize<0>();
+  auto pA = pABC.marginalize<0>();
+  EXPECT_LT(difference(prob::join(pA, pBC), prob::join(lA, lBC)), 1e-12);
+  EXPECT_LT(difference(prob::bayes(pAgBC, pA, pBC), prob::bayes(lAgBC, lA, lBC)), 1e-12);
+
+  lABC.normalize();
+  EXPECT_NEAR(lABC.sum().value(), 1, 1e-12);
+}
+
+TEST_F(LogSpace, Underflow)
+{
+  prob::distribution<double, X> pX(X(2));
+  pX << 1e-120, 1 - 1e-120;
+  prob::distribution<double, Y> pY(Y(2));
+  pY << 1e-120, 1 - 1e-120;
+  prob::distribution<double, Z> pZ(Z(2));
+  pZ << 1e-120, 1 - 1e-120;
+
+  auto pXYZ = prob::join(pX, prob::join(pY, pZ));
+  EXPECT_EQ(pXYZ(X(0), Y(0), Z(0)), 0);
+
+  auto lX = pX.scalar_cast<lp>();
+  auto lYZ = prob::join(pY.scalar_cast<lp>(), pZ.scalar_cast<lp>());
+  auto lXYZ = prob::join(lX, lYZ);
+  EXPECT_NEAR(lXYZ(X(0), Y(0), Z(0)).log(), 3 * std::log(1e-120), 1e-9);
+
+  prob::distribution<lp, X, prob::given, Y, Z> lXgYZ(X(2)|Y(2), Z(2));
+  prob::condition(lXYZ, lYZ, lXgYZ);
+  EXPECT_NEAR(lXgYZ(X(0)|Y(0), Z(0)).log(), std::log(1e-120), 1e-9);
+
+  EXPECT_NEAR(lXYZ.marginalize<0>()(X(0)).log(), std::log(1e-120), 1e-9);
+}
+
+TEST_F(LogSpace, InformationTheory)
+{
+  prob::distribution<double, A, prob::given, C> pAgC;
+  prob::distribution<double, C> pC, qC;
+  prob::init::random(pAgC, gen);
+  prob::init::random(pC, gen);
+  prob::init::random(qC, gen);
+
+  auto lAgC = pAgC.scalar_cast<lp>();
+  auto lC = pC.scalar_cast<lp>();
+  auto mC = qC.scalar_cast<lp>();
+
+  EXPECT_NEAR(prob::it::entropy(lC), prob::it::entropy(pC), 1e-12);
+  EXPECT_NEAR(prob::it::entropy<prob::it::approximate_log>(lC), prob::it::entropy(pC), 1e-12);
+  EXPECT_NEAR(prob::it::conditional_entropy(lAgC, lC),
+      prob::it::conditional_entropy(pAgC, pC), 1e-12);
+  EXPECT_NEAR(prob::it::mutual_information(lAgC, lC),
+      prob::it::mutual_information(pAgC, pC), 1e-12);
+  EXPECT_NEAR(prob::it::kl_divergence(lC, mC), prob::it::kl_divergence(pC, qC), 1e-12);
+  EXPECT_NEAR(prob::it::js_divergence(lC, mC), prob::it::js_divergence(pC, qC), 1e-12);
+}
@@ -0,0 +1,143 @@
+#include "gtest/gtest.h"
+#include "TestVariables.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+class Mapped : public ::testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    gen = std::mt19937(rd());
+  }
+
+  virtual void TearDown()
+  {
+    std::remove(path);
+  }
+
+  template<typename Dist>
+  void save(const Dist& d)
+  {
+    std::ofstream out(path, std::ios::binary);
+    d.save_binary(out);
+  }
+
+  // Overwrite the bytes at offset of the saved file
+  template<typename V>
+  void patch(std::streamoff offset, V value)
+  {
+    std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+    f.seekp(offset);
+    f.write(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  std::random_device rd;
+  std::mt19937 gen;
+
+  const char* path = "mapped_test.prob";
+};
+
+TEST_F(Mapped, Access)
+{
+  prob::distribution<double, X, Y, prob::given, Z> pXYgZ(X(3), Y(4)|Z(5));
+  prob::init::random(pXYgZ, gen);
+  save(pXYgZ);
+
+  prob::mapped_distribution<double, X, Y, prob::given, Z> mXYgZ(path);
+  ASSERT_TRUE(mXYgZ.is_open());
+  EXPECT_EQ(mXYgZ.to_distribution(), pXYgZ);
+
+  int calls = 0;
+  mXYgZ.each_index([&] (const X& x, const Y& y, prob::given g, const Z& z)
+      {
+        EXPECT_EQ(mXYgZ(x, y|z), pXYgZ(x, y|z));
+        ++calls;
+      });
+  EXPECT_EQ(calls, 60);
+
+  EXPECT_EQ((mXYgZ.marginalize<1,2>()), (pXYgZ.marginalize<1,2>()));
+
+  // Other random variables or scalar types than in the file
+  prob::mapped_distribution<double, X, Z, prob::given, Y> mXZgY(path);
+  EXPECT_FALSE(mXZgY.is_open());
+  prob::mapped_distribution<float, X, Y, prob::given, Z> fXYgZ(path);
+  EXPECT_FALSE(fXYgZ.is_open());
+  prob::mapped_distribution<double, X, Y, prob::given, Z> missing("missing.prob");
+  EXPECT_FALSE(missing.is_open());
+}
+
+TEST_F(Mapped, InformationTheory)
+{
+  prob::distribution<double, A, prob::given, C> pAgC;
+  prob::distribution<double, C> pC;
+  prob::init::random(pAgC, gen);
+  prob::init::random(pC, gen);
+
+  save(pAgC);
+  prob::mapped_distribution<double, A, prob::given, C> mAgC(path);
+  ASSERT_TRUE(mAgC.is_open());
+
+  EXPECT_LT(std::abs(prob::it::conditional_entropy(mAgC, pC) -
+      prob::it::conditional_entropy(pAgC, pC)), 1e-12);
+  EXPECT_LT(std::abs(prob::it::mutual_information(mAgC, pC) -
+      prob::it::mutual_information(pAgC, pC)), 1e-12);
+
+  save(pC);
+  prob::mapped_distribution<double, C> mC(path);
+  ASSERT_TRUE(mC.is_open());
+
+  EXPECT_LT(std::abs(prob::it::entropy(mC) - prob::it::entropy(pC)), 1e-12);
+  EXPECT_LT(std::abs(prob::it::mutual_information(pAgC, mC) -
+      prob::it::mutual_information(pAgC, pC)), 1e-12);
+}
+
+TEST_F(Mapped, CorruptHeader)
+{
+  prob::distribution<double, X, Y, prob::given, Z> pXYgZ(X(3), Y(4)|Z(5));
+  prob::init::random(pXYgZ, gen);
+
+  std::stringstream s;
+  pXYgZ.save_binary(s);
+  prob::core::binary_header header;
+  ASSERT_TRUE(header.read(s, 3));
+  std::streamoff rows = header.unpadded_bytes() - 16;
+
+  typedef prob::mapped_distribution<double, X, Y, prob::given, Z> mapped_type;
+
+  // rows * cols * sizeof(double) wraps around to 0
+  save(pXYgZ);
+  patch(rows, std::uint64_t(1) << 61);
+  EXPECT_FALSE(mapped_type(path).is_open());
+
+  // More variables than the type has
+  save(pXYgZ);
+  patch(24, std::uint32_t(0xffffffff));
+  EXPECT_FALSE(mapped_type(path).is_open());
+
+  // A label longer than the file
+  save(pXYgZ);
+  patch(28, std::uint32_t(0xfffffff0));
+  EXPECT_FALSE(mapped_type(path).is_open());
+
+  std::stringstream t;
+  pXYgZ.save_binary(t);
+  std::string bytes = t.str();
+  std::uint32_t length = 0xfffffff0;
+  bytes.replace(28, 4, reinterpret_cast<const char*>(&length), 4);
+  std::stringstream u(bytes);
+  prob::distribution<double, X, Y, prob::given, Z>::load_binary(u);
+  EXPECT_FALSE(bool(u));
+
+  save(pXYgZ);
+  EXPECT_TRUE(mapped_type(path).is_open());
+
+  // Extents of 65537 * 65536 cells wrap around to the stored 65536 in int
+  prob::distribution<double, X, Y> pXY(X(1), Y(65536));
+  pXY.setZero();
+  save(pXY);
+  patch(28 + 4 + std::streamoff(header.labels[0].size()), std::int32_t(65537));
+  EXPECT_FALSE((prob::mapped_distribution<double, X, Y>(path).is_open()));
+}
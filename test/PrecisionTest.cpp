@@ -0,0 +1,99 @@
+#include "gtest/gtest.h"
+#include "TestVariables.hpp"
+
+// Built twice, with and without PROB_MIXED_PRECISION
+
+typedef prob::core::real_scalar<float>::type real;
+
+class Precision : public ::testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    gen = std::mt19937(rd());
+  }
+
+  // Results of float distributions agree with the results of the same
+  // values in double up to the precision of the accumulator
+  double tolerance() const
+  {
+    return PROB_MIXED_PRECISION ? 1e-12 : 1e-4;
+  }
+
+  std::random_device rd;
+  std::mt19937 gen;
+};
+
+TEST_F(Precision, Types)
+{
+  static_assert(std::is_same<real, std::conditional<PROB_MIXED_PRECISION,
+      double, float>::type>::value,
+      "Accumulator of float");
+
+  prob::distribution<float, A> pA;
+  prob::init::random(pA, gen);
+
+  static_assert(std::is_same<decltype(prob::it::entropy(pA)), real>::value,
+      "Entropy of float distributions");
+  EXPECT_NEAR(prob::it::log_of_2<float>(), std::log(2.0f), 1e-7);
+  EXPECT_NEAR(prob::it::log2(8.0f), 3.0f, 1e-6);
+  EXPECT_NEAR(prob::it::xlogy(0.5f, 0.25f), 0.5f * std::log(0.25f), 1e-6);
+}
+
+TEST_F(Precision, Reductions)
+{
+  prob::distribution<float, X> pX(X(1 << 20));
+  pX.setConstant(1.0f / (1 << 20));
+  pX.data()[0] = 1;
+  pX.normalize();
+
+  EXPECT_NEAR(pX.sum(), 1, 1e-6);
+  EXPECT_NEAR(pX.coeff(0), 0.5, 1e-6);
+
+  prob::distribution<float, A, B, prob::given, C> pABgC;
+  prob::init::random(pABgC, gen);
+  auto qABgC = pABgC.scalar_cast<double>();
+
+  EXPECT_LT((pABgC.marginalize<0, 2>().scalar_cast<double>() -
+      qABgC.marginalize<0, 2>()).array().abs().maxCoeff(), 1e-6);
+  EXPECT_LT((pABgC.marginalize<1, 2>().scalar_cast<double>() -
+      qABgC.marginalize<1, 2>()).array().abs().maxCoeff(), 1e-6);
+}
+
+TEST_F(Precision, InformationTheory)
+{
+  prob::distribution<float, A, prob::given, C> pAgC;
+  prob::distribution<float, C> pC, rC;
+  prob::init::random(pAgC, gen);
+  prob::init::random(pC, gen);
+  prob::init::random(rC, gen);
+
+  auto qAgC = pAgC.scalar_cast<double>();
+  auto qC = pC.scalar_cast<double>();
+  auto sC = rC.scalar_cast<double>();
+
+  EXPECT_NEAR(prob::it::entropy(pC), prob::it::entropy(qC), tolerance());
+  EXPECT_NEAR(prob::it::entropy<prob::it::approximate_log>(pC),
+      prob::it::entropy(qC), 1e-5);
+  EXPECT_NEAR(prob::it::conditional_entropy(pAgC, pC),
+      prob::it::conditional_entropy(qAgC, qC), 1e-6);
+  EXPECT_NEAR(prob::it::mutual_information(pAgC, pC),
+      prob::it::mutual_information(qAgC, qC), 1e-5);
+  EXPECT_NEAR(prob::it::kl_divergence(pC, rC), prob::it::kl_divergence(qC, sC), 1e-5);
+  EXPECT_NEAR(prob::it::js_divergence(pC, rC), prob::it::js_divergence(qC, sC), 1e-5);
+}
+
+TEST_F(Precision, ApproximateLog)
+{
+  prob::distribution<float, A, prob::given, C> pAgC;
+  prob::distribution<float, C> pC;
+  prob::init::random(pAgC, gen);
+  prob::init::random(pC, gen);
+
+  // The logarithms of float values are taken in the accumulator type
+  double tolerance = PROB_MIXED_PRECISION ? 1e-8 : 1e-4;
+  EXPECT_NEAR(prob::it::entropy<prob::it::approximate_log>(pC),
+      prob::it::entropy<prob::it::precise_log>(pC), tolerance);
+  EXPECT_NEAR(prob::it::conditional_entropy<prob::it::approximate_log>(pAgC, pC),
+      prob::it::conditional_entropy<prob::it::precise_log>(pAgC, pC), tolerance);
+}
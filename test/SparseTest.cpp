@@ -0,0 +1,169 @@
+#include "gtest/gtest.h"
+#include "TestVariables.hpp"
+
+class Sparse : public ::testing::Test
+{
+protected:
+  virtual void SetUp()
+  {
+    gen = std::mt19937(rd());
+  }
+
+  // Random distribution with about half of the probabilities zero,
+  // every posterior keeps at least one nonzero
+  template<typename Dist>
+  void sparse_random(Dist& d)
+  {
+    std::bernoulli_distribution keep(0.5);
+    prob::init::random(d, gen);
+    for(int i = 0; i < d.size(); ++i)
+      if(!keep(gen))
+        d.data()[i] = 0;
+    for(int r = 0; r < d.rows(); ++r)
+      d.coeffRef(r, r % d.cols()) = 1;
+    d.normalize();
+  }
+
+  std::random_device rd;
+  std::mt19937 gen;
+};
+
+TEST_F(Sparse, Access)
+{
+  prob::sparse_distribution<double, X, Y, prob::given, Z> pXYgZ(X(100), Y(1000)|Z(1000));
+
+  EXPECT_EQ(pXYgZ.size(), 100ll * 1000 * 1000);
+  EXPECT_EQ(pXYgZ.nonZeros(), 0u);
+
+  pXYgZ.prob_ref(X(3), Y(7)|Z(999)) = 0.5;
+  EXPECT_EQ(pXYgZ(X(3), Y(7)|Z(999)), 0.5);
+  EXPECT_EQ(pXYgZ(X(3), Y(8)|Z(999)), 0);
+  EXPECT_EQ(pXYgZ.nonZeros(), 1u);
+
+  int calls = 0;
+  pXYgZ.each_index([&] (const X& x, const Y& y, prob::given, const Z& z)
+      {
+        EXPECT_EQ(prob::read_index<X>::read(x), 3);
+        EXPECT_EQ(prob::read_index<Y>::read(y), 7);
+        EXPECT_EQ(prob::read_index<Z>::read(z), 999);
+        ++calls;
+      });
+  EXPECT_EQ(calls, 1);
+}
+
+TEST_F(Sparse, LargeIndexSpace)
+{
+  // 2^36 columns, then 2^32 rows, beyond the range of int
+  prob::sparse_distribution<double, X, Y, Z, W, S, T> sXYZWST(
+      X(64), Y(64), Z(64), W(64), S(64), T(64));
+  EXPECT_EQ(sXYZWST.cols(), 1ll << 36);
+
+  sXYZWST.prob_ref(X(63), Y(62), Z(61), W(60), S(59), T(58)) = 0.25;
+  sXYZWST.prob_ref(X(1), Y(2), Z(3), W(4), S(5), T(6)) = 0.75;
+  EXPECT_EQ(sXYZWST(X(63), Y(62), Z(61), W(60), S(59), T(58)), 0.25);
+  EXPECT_EQ(sXYZWST(X(63), Y(62), Z(61), W(60), S(59), T(57)), 0);
+  EXPECT_EQ(sXYZWST.nonZeros(), 2u);
+
+  sXYZWST.each_index([&] (const X& x, const Y& y, const Z& z,
+      const W& w, const S& s, const T& t)
+      {
+        EXPECT_EQ(sXYZWST(x, y, z, w, s, t),
+            prob::read_index<X>::read(x) == 63 ? 0.25 : 0.75);
+      });
+
+  auto sXT = sXYZWST.marginalize<0,5>();
+  EXPECT_EQ(sXT(X(63), T(58)), 0.25);
+  EXPECT_EQ(sXT(X(1), T(6)), 0.75);
+
+  prob::sparse_distribution<double, X, Y, Z, prob::given, W, S> sXYZgWS(
+      X(256), Y(256), Z(256)|W(1 << 17), S(1 << 15));
+  EXPECT_EQ(sXYZgWS.rows(), 1ll << 32);
+  EXPECT_EQ(sXYZgWS.cols(), 1ll << 24);
+
+  sXYZgWS.prob_ref(X(255), Y(0), Z(1)|W(131071), S(32766)) = 2;
+  sXYZgWS.prob_ref(X(5), Y(6), Z(7)|W(131071), S(32766)) = 6;
+  sXYZgWS.normalize();
+  EXPECT_EQ(sXYZgWS(X(255), Y(0), Z(1)|W(131071), S(32766)), 0.25);
+  EXPECT_EQ(sXYZgWS(X(5), Y(6), Z(7)|W(131071), S(32766)), 0.75);
+
+  auto sZgS = sXYZgWS.marginalize<2,4>();
+  EXPECT_EQ(sZgS(Z(1)|S(32766)), 0.25);
+  EXPECT_EQ(sZgS(Z(7)|S(32766)), 0.75);
+
+  prob::sparse_distribution<double, X, Y, Z> sXYZ(X(2048), Y(2048), Z(2048));
+  prob::sparse_distribution<double, W, S> sWS(W(2048), S(2048));
+  sXYZ.prob_ref(X(2047), Y(2047), Z(2047)) = 1;
+  sWS.prob_ref(W(2047), S(3)) = 1;
+  auto sXYZWS = prob::join(sXYZ, sWS);
+  EXPECT_EQ(sXYZWS(X(2047), Y(2047), Z(2047), W(2047), S(3)), 1);
+  EXPECT_EQ(sXYZWS.nonZeros(), 1u);
+}
+
+TEST_F(Sparse, Dense)
+{
+  prob::distribution<double, X, Y, prob::given, Z> pXYgZ(X(3), Y(4)|Z(5));
+  sparse_random(pXYgZ);
+
+  prob::sparse_distribution<double, X, Y, prob::given, Z> sXYgZ(pXYgZ);
+  EXPECT_EQ(sXYgZ.to_dense(), pXYgZ);
+  EXPECT_EQ((size_t)(pXYgZ.array() != 0).count(), sXYgZ.nonZeros());
+
+  sXYgZ.each_index([&] (const X& x, const Y& y, prob::given g, const Z& z)
+      {
+        EXPECT_EQ(sXYgZ(x, y|z), pXYgZ(x, y|z));
+      });
+
+  auto qYgZ = sXYgZ.marginalize<1,2>().to_dense();
+  EXPECT_LT((qYgZ - pXYgZ.marginalize<1,2>()).array().abs().sum(), 1e-12);
+
+  auto qXY = sXYgZ.marginalize<0,1>();
+  qXY.normalize();
+  auto rXY = pXYgZ.marginalize<0,1>();
+  rXY.normalize();
+  EXPECT_LT((qXY.to_dense() - rXY).array().abs().sum(), 1e-12);
+}
+
+TEST_F(Sparse, Algebra)
+{
+  prob::distribution<double, X> pX(X(4));
+  prob::distribution<double, Y, Z> pYZ(Y(3), Z(5));
+  sparse_random(pX);
+  sparse_random(pYZ);
+
+  prob::sparse_distribution<double, X> sX(pX);
+  prob::sparse_distribution<double, Y, Z> sYZ(pYZ);
+
+  auto pXYZ = prob::join(pX, pYZ);
+  auto sXYZ = prob::join(sX, sYZ);
+  EXPECT_LT((sXYZ.to_dense() - pXYZ).array().abs().sum(), 1e-12);
+
+  prob::sparse_distribution<double, X, prob::given, Y, Z> sXgYZ;
+  prob::condition(sXYZ, sYZ, sXgYZ);
+
+  sXgYZ.each_index([&] (const X& x, prob::given g, const Y& y, const Z& z)
+      {
+        EXPECT_LT(std::abs(sXgYZ(x|y, z) - pX(x)), 1e-12);
+      });
+
+  EXPECT_LT(std::abs(prob::it::entropy(sXYZ) - prob::it::entropy(pXYZ)), 1e-12);
+  EXPECT_LT(std::abs(prob::it::mutual_information(sXgYZ, sYZ)), 1e-12);
+}
+
+TEST_F(Sparse, InformationTheory)
+{
+  prob::distribution<double, A, prob::given, C> pAgC;
+  prob::distribution<double, C> pC;
+  sparse_random(pAgC);
+  sparse_random(pC);
+
+  prob::sparse_distribution<double, A, prob::given, C> sAgC(pAgC);
+  prob::sparse_distribution<double, C> sC(pC);
+
+  EXPECT_LT(std::abs(prob::it::entropy(sC) - prob::it::entropy(pC)), 1e-12);
+  EXPECT_LT(std::abs(prob::it::conditional_entropy(sAgC, sC) -
+      prob::it::conditional_entropy(pAgC, pC)), 1e-12);
+  EXPECT_LT(std::abs(prob::it::mutual_information(sAgC, sC) -
+      prob::it::mutual_information(pAgC, pC)), 1e-12);
+  EXPECT_LT(std::abs(prob::it::mutual_information<prob::it::approximate_log>(sAgC, sC) -
+      prob::it::mutual_information(pAgC, pC)), 1e-8);
+}
@@ -45,4 +45,22 @@ TEST(Splitter, IndexCheckTest)
   EXPECT_TRUE(!is_valid);
 }
 
+TEST(Splitter, EigenSize)
+{
+  int size;
+  size = prob::core::vars<A,B,C>::eigen_size;
+  EXPECT_EQ(size, A::extent() * B::extent() * C::extent());
+
+  size = prob::core::vars<A,X>::eigen_size;
+  EXPECT_EQ(size, Eigen::Dynamic);
+
+  size = prob::distribution<double,A,B, prob::given, C>::RowsAtCompileTime;
+  EXPECT_EQ(size, C::extent());
+  size = prob::distribution<double,A,B, prob::given, C>::ColsAtCompileTime;
+  EXPECT_EQ(size, A::extent() * B::extent());
+
+  size = prob::distribution<double,X, prob::given, Y>::ColsAtCompileTime;
+  EXPECT_EQ(size, Eigen::Dynamic);
+}
+
 /** @todo Tests for other internal mechanics */